@@ -0,0 +1,11 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/base-tests.dir/tests.cpp.o"
+  "CMakeFiles/base-tests.dir/tests.cpp.o.d"
+  "base-tests"
+  "base-tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/base-tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
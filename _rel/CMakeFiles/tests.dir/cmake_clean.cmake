@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/tests.dir/advanced_tests.cpp.o"
+  "CMakeFiles/tests.dir/advanced_tests.cpp.o.d"
+  "CMakeFiles/tests.dir/tests.cpp.o"
+  "CMakeFiles/tests.dir/tests.cpp.o.d"
+  "tests"
+  "tests.pdb"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/tests.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
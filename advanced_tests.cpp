@@ -1,6 +1,30 @@
+#include "intrusive_atomic_stack.h"
+#include "intrusive_epoch.h"
+#include "intrusive_headless_list.h"
+#include "intrusive_index_list.h"
 #include "intrusive_list.h"
+#include "intrusive_list_algorithms.h"
+#include "intrusive_list_head.h"
+#include "intrusive_mpsc_queue.h"
+#include "intrusive_offset_list.h"
+#include "intrusive_rcu_list.h"
+#include "intrusive_sharded_list.h"
+#include "intrusive_slist.h"
+#include "intrusive_tagged_list.h"
+#include "intrusive_xor_list.h"
 #include "test_utils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
 TEST(advanced_intrusive_list_testing, iterators_01) {
   intrusive::list<node> list;
   auto it1 = list.begin();
@@ -690,3 +714,2105 @@ TEST(advanced_intrusive_list_testing, splice_iterators) {
   EXPECT_EQ(2, std::prev(j)->value);
   EXPECT_EQ(5, std::prev(k)->value);
 }
+
+using sized_list = intrusive::list<node, intrusive::default_tag,
+                                   intrusive::constant_time_size>;
+
+TEST(advanced_intrusive_list_testing, size_linear) {
+  intrusive::list<node> list;
+  node a(1), b(2), c(3);
+  EXPECT_EQ(0, list.size());
+  mass_push_back(list, a, b, c);
+  EXPECT_EQ(3, list.size());
+  list.pop_front();
+  EXPECT_EQ(2, list.size());
+}
+
+TEST(advanced_intrusive_list_testing, size_constant) {
+  static_assert(sizeof(sized_list) > sizeof(intrusive::list<node>));
+  sized_list list;
+  node a(1), b(2), c(3), d(4);
+  EXPECT_EQ(0, list.size());
+  mass_push_back(list, a, b);
+  list.push_front(c);
+  list.insert(std::next(list.begin()), d);
+  EXPECT_EQ(4, list.size());
+  expect_eq(list, {3, 4, 1, 2});
+  list.erase(std::next(list.begin()));
+  list.pop_back();
+  EXPECT_EQ(2, list.size());
+  list.clear();
+  EXPECT_EQ(0, list.size());
+}
+
+TEST(advanced_intrusive_list_testing, size_constant_move) {
+  sized_list list1, list2;
+  node a(1), b(2), c(3), d(4);
+  mass_push_back(list1, a, b, c);
+  sized_list list3 = std::move(list1);
+  EXPECT_EQ(0, list1.size());
+  EXPECT_EQ(3, list3.size());
+  list2.push_back(d);
+  list2 = std::move(list3);
+  EXPECT_EQ(0, list3.size());
+  EXPECT_EQ(3, list2.size());
+  expect_eq(list2, {1, 2, 3});
+}
+
+TEST(advanced_intrusive_list_testing, size_constant_splice) {
+  sized_list c1, c2;
+  node a(1), b(2), c(3), d(4);
+  node e(5), f(6), g(7), h(8);
+  mass_push_back(c1, a, b, c, d);
+  mass_push_back(c2, e, f, g, h);
+  c1.splice(c1.begin(), c2, std::next(c2.begin()), std::prev(c2.end()));
+  EXPECT_EQ(6, c1.size());
+  EXPECT_EQ(2, c2.size());
+  c2.splice(c2.end(), c1, c1.begin(), std::next(c1.begin()), 1);
+  EXPECT_EQ(5, c1.size());
+  EXPECT_EQ(3, c2.size());
+  c1.splice(std::next(c1.begin()), c1, std::prev(c1.end()), c1.end());
+  EXPECT_EQ(5, c1.size());
+  c1.splice(c1.end(), c2);
+  EXPECT_EQ(8, c1.size());
+  EXPECT_EQ(0, c2.size());
+  expect_eq(c1, {7, 4, 1, 2, 3, 5, 8, 6});
+  EXPECT_TRUE(c2.empty());
+}
+
+TEST(advanced_intrusive_list_testing, merge) {
+  intrusive::list<node> c1, c2;
+  node a(1), b(3), c(5), d(7);
+  node e(2), f(3), g(4), h(8);
+  mass_push_back(c1, a, b, c, d);
+  mass_push_back(c2, e, f, g, h);
+  auto less = [](const node& l, const node& r) { return l.value < r.value; };
+  c1.merge(c2, less);
+  expect_eq(c1, {1, 2, 3, 3, 4, 5, 7, 8});
+  EXPECT_TRUE(c2.empty());
+  EXPECT_EQ(&b, &*std::next(c1.begin(), 2));
+  EXPECT_EQ(&f, &*std::next(c1.begin(), 3));
+  c2.merge(c1, less);
+  expect_eq(c2, {1, 2, 3, 3, 4, 5, 7, 8});
+  EXPECT_TRUE(c1.empty());
+}
+
+TEST(advanced_intrusive_list_testing, merge_constant_size) {
+  sized_list c1, c2;
+  node a(1), b(4), c(2), d(3);
+  mass_push_back(c1, a, b);
+  mass_push_back(c2, c, d);
+  c1.merge(c2, [](const node& l, const node& r) { return l.value < r.value; });
+  expect_eq(c1, {1, 2, 3, 4});
+  EXPECT_EQ(4, c1.size());
+  EXPECT_EQ(0, c2.size());
+}
+
+TEST(advanced_intrusive_list_testing, sort) {
+  intrusive::list<node> list;
+  auto less = [](const node& l, const node& r) { return l.value < r.value; };
+  list.sort(less);
+  EXPECT_TRUE(list.empty());
+
+  node a(5), b(3), c(8), d(1), e(9), f(2), g(7), h(4), i(6);
+  list.push_back(a);
+  list.sort(less);
+  expect_eq(list, {5});
+
+  mass_push_back(list, b, c, d, e, f, g, h, i);
+  list.sort(less);
+  expect_eq(list, {1, 2, 3, 4, 5, 6, 7, 8, 9});
+  list.sort([](const node& l, const node& r) { return l.value > r.value; });
+  expect_eq(list, {9, 8, 7, 6, 5, 4, 3, 2, 1});
+}
+
+TEST(advanced_intrusive_list_testing, sort_stable) {
+  sized_list list;
+  std::vector<node> nodes;
+  for (int i = 0; i < 100; ++i) {
+    nodes.emplace_back((i * 37) % 100);
+  }
+  for (auto& n : nodes) {
+    list.push_back(n);
+  }
+  list.sort([](const node& l, const node& r) {
+    return l.value / 10 < r.value / 10;
+  });
+  EXPECT_EQ(100, list.size());
+  for (auto it = list.begin(); std::next(it) != list.end(); ++it) {
+    auto next = std::next(it);
+    EXPECT_LE(it->value / 10, next->value / 10);
+    if (it->value / 10 == next->value / 10) {
+      EXPECT_LT(&*it, &*next);
+    }
+  }
+  list.clear();
+}
+
+/// Comparator throwing on its `limit`-th call
+struct throwing_less {
+  bool operator()(const node& l, const node& r) {
+    if (++*calls == limit) {
+      throw std::runtime_error("comparison failed");
+    }
+    return l.value < r.value;
+  }
+
+  int* calls;
+  int limit;
+};
+
+/// Checks the links of `list` both ways and returns its values, sorted
+template <typename List>
+std::vector<int> checked_values(const List& list) {
+  std::vector<int> values;
+  for (const node& n : list) {
+    values.push_back(n.value);
+  }
+  EXPECT_EQ(values.size(), list.size());
+  std::size_t backward = 0;
+  for (auto it = list.end(); it != list.begin(); --it) {
+    ++backward;
+  }
+  EXPECT_EQ(values.size(), backward);
+  std::sort(values.begin(), values.end());
+  return values;
+}
+
+TEST(advanced_intrusive_list_testing, sort_throwing_compare) {
+  std::vector<node> nodes;
+  std::vector<int> expected;
+  for (int i = 0; i < 100; ++i) {
+    nodes.emplace_back((i * 37) % 100);
+    expected.push_back(i);
+  }
+  for (int limit : {1, 2, 50, 300, 500}) {
+    sized_list list;
+    for (auto& n : nodes) {
+      list.push_back(n);
+    }
+    int calls = 0;
+    EXPECT_THROW(list.sort(throwing_less{&calls, limit}),
+                 std::runtime_error);
+    EXPECT_EQ(expected, checked_values(list));
+    list.clear();
+  }
+}
+
+TEST(advanced_intrusive_list_testing, merge_throwing_compare) {
+  node a(1), b(3), c(5), d(7);
+  node e(2), f(4), g(6), h(8);
+  for (int limit : {1, 3, 5}) {
+    sized_list c1, c2;
+    mass_push_back(c1, a, b, c, d);
+    mass_push_back(c2, e, f, g, h);
+    int calls = 0;
+    EXPECT_THROW(c1.merge(c2, throwing_less{&calls, limit}),
+                 std::runtime_error);
+    std::vector<int> values = checked_values(c1);
+    std::vector<int> rest = checked_values(c2);
+    values.insert(values.end(), rest.begin(), rest.end());
+    std::sort(values.begin(), values.end());
+    EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8}), values);
+    c1.clear();
+    c2.clear();
+  }
+}
+
+TEST(advanced_intrusive_list_testing, radix_sort) {
+  intrusive::list<node> list;
+  auto key = [](const node& n) { return n.value; };
+  intrusive::radix_sort(list, key);
+  EXPECT_TRUE(list.empty());
+
+  node a(70000), b(-5), c(300), d(0), e(-70000), f(7), g(300), h(1);
+  mass_push_back(list, a, b, c, d, e, f, g, h);
+  intrusive::radix_sort(list, key);
+  expect_eq(list, {-70000, -5, 0, 1, 7, 300, 300, 70000});
+  EXPECT_EQ(&c, &*std::next(list.begin(), 5));
+  EXPECT_EQ(&g, &*std::next(list.begin(), 6));
+}
+
+TEST(advanced_intrusive_list_testing, radix_sort_stable) {
+  // long enough to take the wide-digit path
+  constexpr int count = 100000;
+  sized_list list;
+  std::vector<node> nodes;
+  for (int i = 0; i < count; ++i) {
+    nodes.emplace_back((i * 7919) % count);
+  }
+  for (auto& n : nodes) {
+    list.push_back(n);
+  }
+  intrusive::radix_sort(list, [](const node& n) {
+    return static_cast<std::uint64_t>(n.value / 10) << 40;
+  });
+  EXPECT_EQ(count, list.size());
+  for (auto it = list.begin(); std::next(it) != list.end(); ++it) {
+    auto next = std::next(it);
+    ASSERT_LE(it->value / 10, next->value / 10);
+    if (it->value / 10 == next->value / 10) {
+      ASSERT_LT(&*it, &*next);
+    }
+  }
+  EXPECT_EQ(&list.back(), &*std::prev(list.end()));
+  list.clear();
+}
+
+TEST(advanced_intrusive_list_testing, radix_sort_throwing_key) {
+  std::vector<node> nodes;
+  std::vector<int> expected;
+  for (int i = 0; i < 100; ++i) {
+    nodes.emplace_back((i * 37) % 100 * 1000);
+    expected.push_back(i * 1000);
+  }
+  // the first 101 calls happen before the list is taken apart
+  for (int limit : {1, 50, 150, 250}) {
+    sized_list list;
+    for (auto& n : nodes) {
+      list.push_back(n);
+    }
+    int calls = 0;
+    auto key = [&](const node& n) {
+      if (++calls == limit) {
+        throw std::runtime_error("key failed");
+      }
+      return n.value;
+    };
+    EXPECT_THROW(intrusive::radix_sort(list, key), std::runtime_error);
+    EXPECT_EQ(expected, checked_values(list));
+    list.clear();
+  }
+}
+
+TEST(advanced_intrusive_list_testing, clear_and_dispose) {
+  sized_list list;
+  node a(1), b(2), c(3);
+  mass_push_back(list, a, b, c);
+  std::vector<int> disposed;
+  list.clear_and_dispose([&](node& n) {
+    disposed.push_back(n.value);
+    EXPECT_TRUE(list.empty());
+  });
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), disposed);
+  EXPECT_EQ(0, list.size());
+  list.push_back(b);
+  expect_eq(list, {2});
+}
+
+TEST(advanced_intrusive_list_testing, clear_and_dispose_destroys) {
+  intrusive::list<node> list;
+  for (int i = 0; i < 5; ++i) {
+    list.push_back(*new node(i));
+  }
+  int count = 0;
+  list.clear_and_dispose([&](node& n) {
+    ++count;
+    delete &n;
+  });
+  EXPECT_EQ(5, count);
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(advanced_intrusive_list_testing, erase_range) {
+  sized_list list;
+  node a(1), b(2), c(3), d(4), e(5);
+  mass_push_back(list, a, b, c, d, e);
+  auto it = list.erase(std::next(list.begin()), std::prev(list.end()));
+  EXPECT_EQ(5, it->value);
+  expect_eq(list, {1, 5});
+  EXPECT_EQ(2, list.size());
+  it = list.erase(list.begin(), list.begin());
+  EXPECT_EQ(1, it->value);
+  it = list.erase(list.begin(), list.end());
+  EXPECT_TRUE(it == list.end());
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(0, list.size());
+  mass_push_back(list, b, c, d);
+  expect_eq(list, {2, 3, 4});
+  list.clear();
+}
+
+TEST(advanced_intrusive_list_testing, erase_and_dispose) {
+  intrusive::list<node> list;
+  node a(1), b(2), c(3), d(4);
+  mass_push_back(list, a, b, c, d);
+  std::vector<int> disposed;
+  auto dispose = [&](node& n) { disposed.push_back(n.value); };
+  auto it = list.erase_and_dispose(std::next(list.begin()), dispose);
+  EXPECT_EQ(3, it->value);
+  it = list.erase_and_dispose(it, list.end(), dispose);
+  EXPECT_TRUE(it == list.end());
+  EXPECT_EQ((std::vector<int>{2, 3, 4}), disposed);
+  expect_eq(list, {1});
+}
+
+TEST(advanced_intrusive_list_testing, remove_if) {
+  sized_list list;
+  node a(1), b(2), c(3), d(4), e(5), f(6);
+  mass_push_back(list, a, b, c, d, e, f);
+  EXPECT_EQ(3, list.remove_if([](const node& n) { return n.value % 2 == 0; }));
+  expect_eq(list, {1, 3, 5});
+  EXPECT_EQ(3, list.size());
+
+  std::vector<int> disposed;
+  auto removed = list.remove_and_dispose_if(
+      [](const node& n) { return n.value != 3; },
+      [&](node& n) { disposed.push_back(n.value); });
+  EXPECT_EQ(2, removed);
+  EXPECT_EQ((std::vector<int>{1, 5}), disposed);
+  expect_eq(list, {3});
+  EXPECT_EQ(1, list.size());
+  list.clear();
+}
+
+TEST(advanced_intrusive_list_testing, insert_range) {
+  sized_list list;
+  node a(1), b(2), c(3), d(4), e(5);
+  mass_push_back(list, a, e);
+  std::vector<std::reference_wrapper<node>> batch{b, c, d};
+  auto it = list.insert(std::next(list.begin()), batch.begin(), batch.end());
+  EXPECT_EQ(2, it->value);
+  expect_eq(list, {1, 2, 3, 4, 5});
+  EXPECT_EQ(5, list.size());
+  it = list.insert(list.end(), batch.end(), batch.end());
+  EXPECT_TRUE(it == list.end());
+  EXPECT_EQ(5, list.size());
+  list.clear();
+}
+
+TEST(advanced_intrusive_list_testing, insert_range_nodes) {
+  intrusive::list<node> list;
+  std::vector<node> nodes;
+  for (int i = 1; i <= 4; ++i) {
+    nodes.emplace_back(i);
+  }
+  list.insert(list.end(), nodes.begin(), nodes.end());
+  expect_eq(list, {1, 2, 3, 4});
+  // elements already linked are moved, as with a single insert
+  list.insert(list.begin(), nodes.begin() + 2, nodes.end());
+  expect_eq(list, {3, 4, 1, 2});
+  list.clear();
+}
+
+TEST(advanced_intrusive_list_testing, insert_range_list_iterators) {
+  intrusive::list<node> list1, list2;
+  node a(1), b(2), c(3), d(4), e(5);
+  mass_push_back(list1, a, e);
+  mass_push_back(list2, b, c, d);
+  list1.insert(std::next(list1.begin()), std::next(list2.begin()),
+               list2.end());
+  expect_eq(list1, {1, 3, 4, 5});
+  expect_eq(list2, {2});
+  auto it = list1.insert(list1.begin(), list2.begin(), list2.end());
+  EXPECT_EQ(2, it->value);
+  expect_eq(list1, {2, 1, 3, 4, 5});
+  EXPECT_TRUE(list2.empty());
+  list1.clear();
+}
+
+TEST(advanced_intrusive_list_testing, insert_initializer_list) {
+  intrusive::list<node> list1, list2;
+  node a(1), b(2), c(3), d(4);
+  mass_push_back(list1, b, d);
+  auto it = list1.insert(list1.begin(), {a});
+  EXPECT_TRUE(it == list1.begin());
+  list2.push_back(c);
+  list1.insert(std::prev(list1.end()), {c});
+  expect_eq(list1, {1, 2, 3, 4});
+  EXPECT_TRUE(list2.empty());
+}
+
+TEST(advanced_intrusive_list_testing, iterator_to) {
+  intrusive::list<node> list;
+  node a(1), b(2), c(3), d(4);
+  mass_push_back(list, a, b, c);
+
+  auto it = list.iterator_to(b);
+  EXPECT_EQ(&b, &*it);
+  EXPECT_TRUE(std::next(list.begin()) == it);
+  intrusive::list<node>::const_iterator cit =
+      std::as_const(list).iterator_to(c);
+  EXPECT_EQ(&c, &*cit);
+  EXPECT_TRUE(std::prev(list.end()) == cit);
+
+  list.insert(std::next(list.iterator_to(b)), d);
+  expect_eq(list, {1, 2, 4, 3});
+  list.erase(intrusive::list<node>::s_iterator_to(a));
+  expect_eq(list, {2, 4, 3});
+  EXPECT_TRUE(intrusive::list<node>::s_iterator_to(std::as_const(d)) ==
+              std::next(list.begin()));
+}
+
+TEST(advanced_intrusive_list_testing, relayout) {
+  std::vector<std::unique_ptr<node>> owned;
+  intrusive::list<node> list;
+  for (int i : {4, 0, 3, 1, 2}) {
+    owned.push_back(std::make_unique<node>(i));
+  }
+  for (int i : {0, 1, 2, 3, 4}) {
+    list.push_back(*owned[i]);
+  }
+  expect_eq(list, {4, 0, 3, 1, 2});
+
+  std::pmr::monotonic_buffer_resource arena;
+  int disposed = 0;
+  intrusive::relayout(list, arena, [&](node& old) {
+    EXPECT_FALSE(old.value < 0);
+    old.value = -1;
+    ++disposed;
+  });
+  EXPECT_EQ(5, disposed);
+  expect_eq(list, {4, 0, 3, 1, 2});
+  const node* prev = nullptr;
+  for (auto& n : list) {
+    EXPECT_TRUE(prev == nullptr || prev < &n);
+    prev = &n;
+  }
+  for (auto& n : owned) {
+    EXPECT_EQ(-1, n->value);
+  }
+  while (!list.empty()) {
+    node& n = list.front();
+    list.pop_front();
+    n.~node();
+  }
+}
+
+TEST(advanced_intrusive_list_testing, relayout_disposes_old) {
+  intrusive::list<node, intrusive::default_tag, intrusive::constant_time_size>
+      list;
+  for (int i = 0; i < 4; ++i) {
+    list.push_back(*new node(i));
+  }
+  std::pmr::monotonic_buffer_resource arena;
+  intrusive::relayout(list, arena, [](node& old) { delete &old; });
+  EXPECT_EQ(4u, list.size());
+  expect_eq(list, {0, 1, 2, 3});
+  list.clear_and_dispose([](node& n) { n.~node(); });
+}
+
+TEST(advanced_intrusive_list_testing, for_each_prefetch) {
+  std::vector<node> nodes;
+  for (int i = 0; i < 40; ++i) {
+    nodes.emplace_back(i);
+  }
+  intrusive::list<node> list;
+  for (auto& n : nodes) {
+    list.push_back(n);
+  }
+  for (std::size_t distance : {0, 1, 3, 15, 100}) {
+    std::vector<int> visited;
+    intrusive::for_each_prefetch(
+        list, [&](node& n) { visited.push_back(n.value); }, distance);
+    ASSERT_EQ(40u, visited.size());
+    for (int i = 0; i < 40; ++i) {
+      EXPECT_EQ(i, visited[i]);
+    }
+  }
+
+  intrusive::for_each_prefetch(list, [&](node& n) {
+    if (n.value % 2 == 1) {
+      list.erase(list.iterator_to(n));
+    }
+  });
+  EXPECT_EQ(20u, list.size());
+  EXPECT_EQ(38, list.back().value);
+}
+
+TEST(advanced_intrusive_list_testing, for_each_prefetch_short) {
+  node a(1), b(2);
+  intrusive::list<node> list;
+  int calls = 0;
+  intrusive::for_each_prefetch(list, [&](node&) { ++calls; });
+  EXPECT_EQ(0, calls);
+  mass_push_back(list, a, b);
+  int sum = 0;
+  intrusive::for_each_prefetch(list, [&](node& n) { sum += n.value; }, 8);
+  EXPECT_EQ(3, sum);
+}
+
+TEST(advanced_intrusive_list_testing, prefetching_iterator) {
+  node a(1), b(2), c(3), d(4), e(5);
+  intrusive::list<node> list;
+  mass_push_back(list, a, b, c, d, e);
+  using iterator =
+      intrusive::prefetching_iterator<intrusive::list<node>::iterator, 2>;
+  iterator first{list.begin(), list.end()};
+  iterator last{list.end(), list.end()};
+  std::vector<int> values;
+  for (auto it = first; it != last; ++it) {
+    values.push_back(it->value);
+  }
+  EXPECT_EQ((std::vector<int>{1, 2, 3, 4, 5}), values);
+  auto found = std::find_if(first, last, [](node& n) { return n.value == 4; });
+  EXPECT_EQ(&d, &*found);
+  EXPECT_EQ(3, std::distance(first, found));
+
+  std::vector<int> ints{7, 8};
+  intrusive::prefetching_iterator<std::vector<int>::iterator, 8> it{
+      ints.begin(), ints.end()};
+  EXPECT_EQ(7, *it++);
+  EXPECT_EQ(8, *it++);
+  EXPECT_TRUE(it == decltype(it)(ints.end(), ints.end()));
+}
+
+TEST(advanced_intrusive_list_testing, interleaved_for_each) {
+  std::vector<node> nodes;
+  for (int i = 0; i < 100; ++i) {
+    nodes.emplace_back(i);
+  }
+  // squares modulo 12 are 0, 1, 4 or 9, so most lists stay empty and the
+  // others have different lengths
+  auto owner = [](const node& n) { return n.value * n.value % 12; };
+  std::vector<intrusive::list<node>> lists(12);
+  for (auto& n : nodes) {
+    lists[owner(n)].push_back(n);
+  }
+  std::vector<intrusive::list<node>*> pointers;
+  for (auto& l : lists) {
+    pointers.push_back(&l);
+  }
+  std::span<intrusive::list<node>* const> span{pointers};
+
+  auto check = [&](auto traverse) {
+    std::vector<int> last_seen(12, -1);
+    std::vector<std::size_t> count(12, 0);
+    traverse([&](node& n) {
+      EXPECT_LT(last_seen[owner(n)], n.value);
+      last_seen[owner(n)] = n.value;
+      ++count[owner(n)];
+    });
+    for (int k = 0; k < 12; ++k) {
+      EXPECT_EQ(lists[k].size(), count[k]);
+    }
+  };
+  check([&](auto f) { intrusive::interleaved_for_each<1>(span, f); });
+  check([&](auto f) { intrusive::interleaved_for_each<3>(span, f); });
+  check([&](auto f) { intrusive::interleaved_for_each(span, f); });
+  check([&](auto f) { intrusive::interleaved_for_each<64>(span, f); });
+  // ranges of list pointers other than spans
+  check([&](auto f) { intrusive::interleaved_for_each<4>(pointers, f); });
+  intrusive::list<node>* array[12];
+  std::copy(pointers.begin(), pointers.end(), array);
+  check([&](auto f) { intrusive::interleaved_for_each<4>(array, f); });
+}
+
+TEST(advanced_intrusive_list_testing, interleaved_for_each_erase) {
+  std::vector<node> nodes;
+  for (int i = 0; i < 30; ++i) {
+    nodes.emplace_back(i);
+  }
+  std::vector<intrusive::list<node>> lists(4);
+  for (auto& n : nodes) {
+    lists[n.value % 4].push_back(n);
+  }
+  std::vector<intrusive::list<node>*> pointers{&lists[0], &lists[1],
+                                               &lists[2], &lists[3]};
+  intrusive::interleaved_for_each<2>(pointers, [&](node& n) {
+    if (n.value % 3 == 0) {
+      auto& l = lists[n.value % 4];
+      l.erase(l.iterator_to(n));
+    }
+  });
+  int remaining = 0;
+  for (auto& l : lists) {
+    for (auto& n : l) {
+      EXPECT_NE(0, n.value % 3);
+      ++remaining;
+    }
+  }
+  EXPECT_EQ(20, remaining);
+}
+
+TEST(advanced_intrusive_list_testing, erase_batch) {
+  std::vector<node> nodes;
+  for (int i = 0; i < 30; ++i) {
+    nodes.emplace_back(i);
+  }
+  intrusive::list<node> list;
+  for (auto& n : nodes) {
+    list.push_back(n);
+  }
+  // adjacent runs, both ends and an order unrelated to the list's
+  std::vector<node*> victims;
+  for (int i : {29, 5, 0, 6, 4, 1, 20, 28, 12, 13, 14, 27, 2}) {
+    victims.push_back(&nodes[i]);
+  }
+  list.erase_batch(victims);
+  expect_eq(list, {3, 7, 8, 9, 10, 11, 15, 16, 17, 18, 19, 21, 22, 23, 24,
+                   25, 26});
+  list.erase_batch({});
+  EXPECT_EQ(17u, list.size());
+  for (node* victim : victims) {
+    list.push_front(*victim);
+  }
+  EXPECT_EQ(30u, list.size());
+}
+
+TEST(advanced_intrusive_list_testing, erase_and_dispose_batch) {
+  std::vector<node> nodes;
+  for (int i = 0; i < 20; ++i) {
+    nodes.emplace_back(i);
+  }
+  sized_list list;
+  for (auto& n : nodes) {
+    list.push_back(n);
+  }
+  std::vector<node*> victims;
+  for (auto& n : nodes) {
+    if (n.value % 4 != 1) {
+      victims.push_back(&n);
+    }
+  }
+  int disposed = 0;
+  list.erase_and_dispose_batch(victims, [&](node& n) {
+    EXPECT_NE(1, n.value % 4);
+    ++disposed;
+  });
+  EXPECT_EQ(15, disposed);
+  EXPECT_EQ(5u, list.size());
+  expect_eq(list, {1, 5, 9, 13, 17});
+}
+
+struct member_node {
+  explicit member_node(int value) : value(value) {}
+
+  int value;
+  intrusive::list_element<> hot_hook;
+  char padding[40]{};
+  intrusive::list_element<> cold_hook;
+};
+
+using hot_hook = intrusive::member_hook<&member_node::hot_hook>;
+using cold_hook = intrusive::member_hook<&member_node::cold_hook>;
+using hot_list = intrusive::list<member_node, hot_hook>;
+using cold_list =
+    intrusive::list<member_node, cold_hook, intrusive::constant_time_size>;
+
+TEST(advanced_intrusive_list_testing, member_hook) {
+  hot_list hot;
+  cold_list cold;
+  member_node a(1), b(2), c(3);
+  mass_push_back(hot, a, b, c);
+  mass_push_back(cold, c, a);
+  expect_eq(hot, {1, 2, 3});
+  expect_eq(cold, {3, 1});
+  EXPECT_EQ(&b, &*std::next(hot.begin()));
+  EXPECT_EQ(&a, &cold.back());
+  EXPECT_EQ(2, cold.size());
+
+  hot.erase(hot.iterator_to(b));
+  cold.push_front(b);
+  expect_eq(hot, {1, 3});
+  expect_eq(cold, {2, 3, 1});
+  cold.sort([](const member_node& l, const member_node& r) {
+    return l.value < r.value;
+  });
+  expect_eq(cold, {1, 2, 3});
+  cold.clear();
+}
+
+TEST(advanced_intrusive_list_testing, member_hook_auto_unlink) {
+  hot_list list;
+  member_node a(1), c(3);
+  list.push_back(a);
+  {
+    member_node b(2);
+    list.push_back(b);
+    list.push_back(c);
+    expect_eq(list, {1, 2, 3});
+  }
+  expect_eq(list, {1, 3});
+}
+
+struct member_base_padding {
+  virtual ~member_base_padding() = default;
+
+  long padding[3]{};
+};
+
+/// Abstract, with the hook in a base that isn't the first one
+struct shape : member_base_padding, member_node {
+  explicit shape(int value) : member_node(value) {}
+
+  virtual int sides() const = 0;
+};
+
+struct triangle : shape {
+  using shape::shape;
+
+  int sides() const override {
+    return 3;
+  }
+};
+
+TEST(advanced_intrusive_list_testing, member_hook_in_base) {
+  intrusive::list<shape, intrusive::member_hook<&member_node::hot_hook>>
+      list;
+  triangle a(1), b(2), c(3);
+  mass_push_back(list, a, b, c);
+  EXPECT_EQ(&a, &list.front());
+  EXPECT_EQ(&b, &*std::next(list.begin()));
+  EXPECT_EQ(&c, &list.back());
+  EXPECT_EQ(3, list.back().sides());
+  expect_eq(list, {1, 2, 3});
+  list.clear();
+}
+
+struct normal_node
+    : intrusive::list_element<intrusive::default_tag,
+                              intrusive::link_mode::normal> {
+  explicit normal_node(int value) : value(value) {}
+
+  int value;
+};
+
+struct checked_node
+    : intrusive::list_element<intrusive::default_tag,
+                              intrusive::link_mode::checked> {
+  explicit checked_node(int value) : value(value) {}
+
+  int value;
+};
+
+TEST(advanced_intrusive_list_testing, link_mode_normal) {
+  intrusive::list<normal_node> list;
+  normal_node a(1), b(2), c(3), d(4);
+  mass_push_back(list, a, b, c);
+  list.push_front(d);
+  expect_eq(list, {4, 1, 2, 3});
+  list.erase(std::next(list.begin()));
+  list.pop_back();
+  expect_eq(list, {4, 2});
+  list.clear();
+  EXPECT_TRUE(list.empty());
+  mass_push_back(list, c, b, a);
+  expect_eq(list, {3, 2, 1});
+}
+
+TEST(advanced_intrusive_list_testing, link_mode_normal_move) {
+  intrusive::list<normal_node> list1, list2;
+  normal_node a(1), b(2), c(3), d(4);
+  mass_push_back(list1, a, b, c);
+  intrusive::list<normal_node> list3 = std::move(list1);
+  EXPECT_TRUE(list1.empty());
+  list2.push_back(d);
+  list2 = std::move(list3);
+  EXPECT_TRUE(list3.empty());
+  expect_eq(list2, {1, 2, 3});
+}
+
+TEST(advanced_intrusive_list_testing, link_mode_normal_destroy_linked) {
+  intrusive::list<normal_node> list;
+  normal_node a(1);
+  {
+    normal_node b(2);
+    mass_push_back(list, a, b);
+    list.clear();
+  }
+  list.push_back(a);
+  expect_eq(list, {1});
+  list.clear();
+}
+
+TEST(advanced_intrusive_list_testing, link_mode_checked) {
+  checked_node a(1), b(2), c(3);
+  intrusive::list<checked_node> list;
+  mass_push_back(list, a, b, c);
+  list.erase(std::next(list.begin()));
+  list.push_front(b);
+  expect_eq(list, {2, 1, 3});
+  list.clear();
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(advanced_intrusive_list_testing, remove_if_normal_mode) {
+  intrusive::list<normal_node> list;
+  normal_node a(1), b(2), c(3);
+  mass_push_back(list, a, b, c);
+  EXPECT_EQ(1, list.remove_if([](const auto& n) { return n.value == 2; }));
+  expect_eq(list, {1, 3});
+  list.erase(list.begin(), list.end());
+  EXPECT_TRUE(list.empty());
+  list.push_back(b);
+  expect_eq(list, {2});
+}
+
+struct slist_node : intrusive::slist_element<> {
+  explicit slist_node(int value) : value(value) {}
+
+  int value;
+};
+
+using tail_slist =
+    intrusive::slist<slist_node, intrusive::default_tag, intrusive::cache_last>;
+
+TEST(advanced_intrusive_slist_testing, hook_size) {
+  static_assert(sizeof(intrusive::slist_element<>) == sizeof(void*));
+  static_assert(sizeof(intrusive::slist<slist_node>) == sizeof(void*));
+  static_assert(sizeof(tail_slist) == 2 * sizeof(void*));
+}
+
+TEST(advanced_intrusive_slist_testing, push_pop_front) {
+  slist_node a(1), b(2), c(3);
+  intrusive::slist<slist_node> list;
+  EXPECT_TRUE(list.empty());
+  list.push_front(c);
+  list.push_front(b);
+  list.push_front(a);
+  expect_forward_eq(list, {1, 2, 3});
+  EXPECT_EQ(1, std::as_const(list).front().value);
+  list.pop_front();
+  expect_forward_eq(list, {2, 3});
+  list.clear();
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(advanced_intrusive_slist_testing, push_back) {
+  slist_node a(1), b(2), c(3), d(4);
+  tail_slist list;
+  mass_push_back(list, b, c);
+  list.push_front(a);
+  EXPECT_EQ(3, list.back().value);
+  list.push_back(d);
+  EXPECT_EQ(4, list.back().value);
+  expect_forward_eq(list, {1, 2, 3, 4});
+  while (!list.empty()) {
+    list.pop_front();
+  }
+  list.push_back(c);
+  EXPECT_EQ(3, list.front().value);
+  EXPECT_EQ(3, list.back().value);
+}
+
+TEST(advanced_intrusive_slist_testing, insert_erase_after) {
+  slist_node a(1), b(2), c(3), d(4);
+  tail_slist list;
+  mass_push_back(list, a, c);
+  auto it = list.insert_after(list.begin(), b);
+  EXPECT_EQ(2, it->value);
+  list.insert_after(std::next(it), d);
+  EXPECT_EQ(4, list.back().value);
+  expect_forward_eq(list, {1, 2, 3, 4});
+
+  it = list.erase_after(list.begin());
+  EXPECT_EQ(3, it->value);
+  it = list.erase_after(it);
+  EXPECT_TRUE(it == list.end());
+  EXPECT_EQ(3, list.back().value);
+  expect_forward_eq(list, {1, 3});
+}
+
+TEST(advanced_intrusive_slist_testing, splice_after_range) {
+  slist_node a(1), b(2), c(3);
+  slist_node d(4), e(5), f(6);
+  tail_slist c1, c2;
+  mass_push_back(c1, a, b, c);
+  mass_push_back(c2, d, e, f);
+  c1.splice_after(c1.begin(), c2, c2.begin(), std::next(c2.begin(), 2));
+  expect_forward_eq(c1, {1, 5, 6, 2, 3});
+  expect_forward_eq(c2, {4});
+  EXPECT_EQ(4, c2.back().value);
+  c2.splice_after(c2.begin(), c1, c1.before_begin(), c1.begin());
+  expect_forward_eq(c1, {5, 6, 2, 3});
+  expect_forward_eq(c2, {4, 1});
+  EXPECT_EQ(1, c2.back().value);
+}
+
+TEST(advanced_intrusive_slist_testing, splice_after_whole) {
+  slist_node a(1), b(2), c(3), d(4);
+  intrusive::slist<slist_node> c1, c2;
+  c1.push_front(b);
+  c1.push_front(a);
+  c2.push_front(d);
+  c2.push_front(c);
+  c1.splice_after(c1.begin(), c2);
+  expect_forward_eq(c1, {1, 3, 4, 2});
+  EXPECT_TRUE(c2.empty());
+  c2.splice_after(c2.before_begin(), c1);
+  EXPECT_TRUE(c1.empty());
+  expect_forward_eq(c2, {1, 3, 4, 2});
+}
+
+TEST(advanced_intrusive_slist_testing, move) {
+  slist_node a(1), b(2), c(3);
+  tail_slist list1, list2;
+  mass_push_back(list1, a, b);
+  tail_slist list3 = std::move(list1);
+  EXPECT_TRUE(list1.empty());
+  list3.push_back(c);
+  list2 = std::move(list3);
+  EXPECT_TRUE(list3.empty());
+  expect_forward_eq(list2, {1, 2, 3});
+  EXPECT_EQ(3, list2.back().value);
+}
+
+struct offset_node : intrusive::offset_list_element<> {
+  explicit offset_node(int value) : value(value) {}
+
+  int value;
+};
+
+struct offset_arena {
+  offset_node& operator[](std::size_t i) {
+    return nodes[i];
+  }
+
+  offset_node nodes[8]{offset_node(1), offset_node(2), offset_node(3),
+                       offset_node(4), offset_node(5), offset_node(6),
+                       offset_node(7), offset_node(8)};
+};
+
+TEST(advanced_intrusive_offset_list_testing, hook_size) {
+  static_assert(sizeof(intrusive::offset_list_element<>) ==
+                2 * sizeof(std::uint32_t));
+}
+
+TEST(advanced_intrusive_offset_list_testing, ends) {
+  offset_arena arena;
+  intrusive::offset_list<offset_node> list(&arena);
+  EXPECT_TRUE(list.empty());
+  list.push_back(arena[1]);
+  list.push_back(arena[2]);
+  list.push_front(arena[0]);
+  expect_eq(list, {1, 2, 3});
+  EXPECT_EQ(1, list.front().value);
+  EXPECT_EQ(3, std::as_const(list).back().value);
+  list.pop_front();
+  list.pop_back();
+  expect_eq(list, {2});
+  list.pop_back();
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(advanced_intrusive_offset_list_testing, insert_erase) {
+  offset_arena arena;
+  intrusive::offset_list<offset_node> list(&arena);
+  mass_push_back(list, arena[0], arena[2], arena[3]);
+  auto it = list.insert(std::next(list.begin()), arena[1]);
+  EXPECT_EQ(2, it->value);
+  expect_eq(list, {1, 2, 3, 4});
+  it = list.erase(std::next(it));
+  EXPECT_EQ(4, it->value);
+  it = list.erase(it);
+  EXPECT_TRUE(it == list.end());
+  expect_eq(list, {1, 2});
+  list.push_back(arena[3]);
+  expect_eq(list, {1, 2, 4});
+}
+
+TEST(advanced_intrusive_offset_list_testing, splice) {
+  offset_arena arena;
+  intrusive::offset_list<offset_node> c1(&arena), c2(&arena);
+  mass_push_back(c1, arena[0], arena[1], arena[2], arena[3]);
+  mass_push_back(c2, arena[4], arena[5], arena[6], arena[7]);
+  c1.splice(std::next(c1.begin(), 2), c2, std::next(c2.begin()),
+            std::prev(c2.end()));
+  expect_eq(c1, {1, 2, 6, 7, 3, 4});
+  expect_eq(c2, {5, 8});
+  c1.splice(c1.end(), c2, c2.begin(), c2.end());
+  expect_eq(c1, {1, 2, 6, 7, 3, 4, 5, 8});
+  EXPECT_TRUE(c2.empty());
+  c1.splice(c1.begin(), c1, std::prev(c1.end()), c1.end());
+  expect_eq(c1, {8, 1, 2, 6, 7, 3, 4, 5});
+}
+
+TEST(advanced_intrusive_offset_list_testing, move) {
+  offset_arena arena;
+  intrusive::offset_list<offset_node> list1(&arena), list2(&arena);
+  mass_push_back(list1, arena[0], arena[1], arena[2]);
+  intrusive::offset_list<offset_node> list3 = std::move(list1);
+  EXPECT_TRUE(list1.empty());
+  list2.push_back(arena[3]);
+  list2 = std::move(list3);
+  EXPECT_TRUE(list3.empty());
+  expect_eq(list2, {1, 2, 3});
+  list1.push_back(arena[3]);
+  expect_eq(list1, {4});
+}
+
+TEST(advanced_intrusive_headless_list_testing, size) {
+  static_assert(sizeof(intrusive::headless_list<normal_node>) == sizeof(void*));
+  intrusive::headless_list<normal_node> list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_TRUE(list.begin() == list.end());
+}
+
+TEST(advanced_intrusive_headless_list_testing, ends) {
+  normal_node a(1), b(2), c(3), d(4);
+  intrusive::headless_list<normal_node> list;
+  list.push_back(b);
+  list.push_front(a);
+  list.push_back(c);
+  list.push_front(d);
+  expect_eq(list, {4, 1, 2, 3});
+  EXPECT_EQ(4, list.front().value);
+  EXPECT_EQ(3, std::as_const(list).back().value);
+  list.pop_front();
+  list.pop_back();
+  expect_eq(list, {1, 2});
+  list.pop_back();
+  list.pop_back();
+  EXPECT_TRUE(list.empty());
+  list.push_back(c);
+  expect_eq(list, {3});
+}
+
+TEST(advanced_intrusive_headless_list_testing, single_element) {
+  normal_node a(1), b(2);
+  intrusive::headless_list<normal_node> list;
+  auto it = list.insert(list.end(), a);
+  EXPECT_TRUE(it == list.begin());
+  EXPECT_TRUE(std::next(list.begin()) == list.end());
+  EXPECT_TRUE(std::prev(list.end()) == list.begin());
+  EXPECT_EQ(&a, &list.front());
+  EXPECT_EQ(&a, &list.back());
+  expect_eq(list, {1});
+  it = list.erase(list.begin());
+  EXPECT_TRUE(it == list.end());
+  EXPECT_TRUE(list.empty());
+
+  list.push_front(b);
+  list.push_front(a);
+  list.pop_back();
+  expect_eq(list, {1});
+  list.pop_front();
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(advanced_intrusive_headless_list_testing, single_element_elsewhere) {
+  normal_node a(1), b(2);
+  intrusive::headless_list<normal_node> list1, list2;
+  list1.push_back(a);
+  list1.erase(list1.begin());
+  // once erased, the element can be inserted into any container
+  intrusive::list<normal_node> other;
+  other.push_back(a);
+  other.push_back(b);
+  expect_eq(other, {1, 2});
+  other.clear();
+
+  list1.push_back(a);
+  list2.splice(list2.end(), list1);
+  EXPECT_TRUE(list1.empty());
+  expect_eq(list2, {1});
+  list2.push_back(b);
+  expect_eq(list2, {1, 2});
+}
+
+TEST(advanced_intrusive_headless_list_testing, insert_erase) {
+  normal_node a(1), b(2), c(3), d(4);
+  intrusive::headless_list<normal_node> list;
+  mass_push_back(list, a, c);
+  auto it = list.insert(list.iterator_to(c), b);
+  EXPECT_EQ(2, it->value);
+  it = list.insert(list.end(), d);
+  EXPECT_EQ(4, it->value);
+  expect_eq(list, {1, 2, 3, 4});
+
+  it = list.erase(list.begin());
+  EXPECT_TRUE(it == list.begin());
+  EXPECT_EQ(2, it->value);
+  it = list.erase(list.iterator_to(d));
+  EXPECT_TRUE(it == list.end());
+  it = list.erase(list.iterator_to(b));
+  EXPECT_EQ(3, it->value);
+  expect_eq(list, {3});
+  list.clear();
+  EXPECT_TRUE(list.empty());
+  mass_push_back(list, a, b);
+  expect_eq(list, {1, 2});
+}
+
+TEST(advanced_intrusive_headless_list_testing, splice) {
+  normal_node a(1), b(2), c(3), d(4), e(5), f(6);
+  intrusive::headless_list<normal_node> c1, c2, c3;
+  mass_push_back(c1, a, b);
+  mass_push_back(c2, c, d);
+  c1.splice(std::next(c1.begin()), c2);
+  expect_eq(c1, {1, 3, 4, 2});
+  EXPECT_TRUE(c2.empty());
+  mass_push_back(c2, e);
+  c1.splice(c1.begin(), c2);
+  expect_eq(c1, {5, 1, 3, 4, 2});
+  mass_push_back(c2, f);
+  c1.splice(c1.end(), c2);
+  expect_eq(c1, {5, 1, 3, 4, 2, 6});
+  c3.splice(c3.end(), c1);
+  EXPECT_TRUE(c1.empty());
+  expect_eq(c3, {5, 1, 3, 4, 2, 6});
+}
+
+TEST(advanced_intrusive_headless_list_testing, move) {
+  normal_node a(1), b(2), c(3);
+  intrusive::headless_list<normal_node> list1, list2;
+  mass_push_back(list1, a, b);
+  intrusive::headless_list<normal_node> list3 = std::move(list1);
+  EXPECT_TRUE(list1.empty());
+  list2.push_back(c);
+  list2 = std::move(list3);
+  EXPECT_TRUE(list3.empty());
+  expect_eq(list2, {1, 2});
+  list1.push_back(c);
+  expect_eq(list1, {3});
+}
+
+struct head_node : intrusive::list_head_element<> {
+  explicit head_node(int value) : value(value) {}
+
+  int value;
+};
+
+TEST(advanced_intrusive_list_head_testing, size) {
+  static_assert(sizeof(intrusive::list_head<head_node>) == sizeof(void*));
+  intrusive::list_head<head_node> head;
+  EXPECT_TRUE(head.empty());
+  EXPECT_TRUE(head.begin() == head.end());
+}
+
+TEST(advanced_intrusive_list_head_testing, push_pop_front) {
+  head_node a(1), b(2), c(3);
+  intrusive::list_head<head_node> head;
+  head.push_front(c);
+  head.push_front(b);
+  head.push_front(a);
+  expect_forward_eq(head, {1, 2, 3});
+  EXPECT_EQ(1, head.front().value);
+  head.pop_front();
+  expect_forward_eq(head, {2, 3});
+  head.clear();
+  EXPECT_TRUE(head.empty());
+}
+
+TEST(advanced_intrusive_list_head_testing, insert_erase) {
+  head_node a(1), b(2), c(3), d(4);
+  intrusive::list_head<head_node> head;
+  head.push_front(a);
+  head.insert_after(head.begin(), c);
+  head.insert_after(head.begin(), b);
+  head.insert_after(head.iterator_to(c), d);
+  expect_forward_eq(head, {1, 2, 3, 4});
+
+  auto it = head.erase(head.iterator_to(b));
+  EXPECT_EQ(3, it->value);
+  it = head.erase(head.iterator_to(d));
+  EXPECT_TRUE(it == head.end());
+  it = head.erase(head.begin());
+  EXPECT_TRUE(it == head.begin());
+  expect_forward_eq(head, {3});
+}
+
+TEST(advanced_intrusive_list_head_testing, self_unlink) {
+  head_node a(1), c(3);
+  intrusive::list_head<head_node> head;
+  head.push_front(c);
+  {
+    head_node b(2);
+    head.push_front(b);
+    head.push_front(a);
+    expect_forward_eq(head, {1, 2, 3});
+  }
+  expect_forward_eq(head, {1, 3});
+  intrusive::list_head<head_node>::unlink(a);
+  expect_forward_eq(head, {3});
+  intrusive::list_head<head_node>::unlink(c);
+  EXPECT_TRUE(head.empty());
+}
+
+TEST(advanced_intrusive_list_head_testing, move_between_containers) {
+  head_node a(1), b(2);
+  intrusive::list_head<head_node> head;
+  intrusive::list<head_node> list;
+  head.push_front(b);
+  head.push_front(a);
+  list.push_back(b);
+  expect_forward_eq(head, {1});
+  expect_eq(list, {2});
+  head_node moved = std::move(a);
+  expect_forward_eq(head, {1});
+  EXPECT_TRUE(head.begin() == head.iterator_to(moved));
+  list.erase(list.begin());
+  head.push_front(b);
+  expect_forward_eq(head, {2, 1});
+}
+
+TEST(advanced_intrusive_list_head_testing, move) {
+  head_node a(1), b(2), c(3);
+  intrusive::list_head<head_node> head1, head2;
+  head1.push_front(b);
+  head1.push_front(a);
+  intrusive::list_head<head_node> head3 = std::move(head1);
+  EXPECT_TRUE(head1.empty());
+  head2.push_front(c);
+  head2 = std::move(head3);
+  EXPECT_TRUE(head3.empty());
+  expect_forward_eq(head2, {1, 2});
+  intrusive::list_head<head_node>::unlink(a);
+  expect_forward_eq(head2, {2});
+}
+
+TEST(advanced_intrusive_list_head_testing, bucket_array) {
+  std::vector<head_node> nodes;
+  for (int i = 0; i < 8; ++i) {
+    nodes.emplace_back(i);
+  }
+  std::vector<intrusive::list_head<head_node>> buckets(3);
+  for (auto& n : nodes) {
+    buckets[n.value % 3].push_front(n);
+  }
+  expect_forward_eq(buckets[0], {6, 3, 0});
+  expect_forward_eq(buckets[2], {5, 2});
+  nodes.pop_back();
+  nodes.pop_back();
+  expect_forward_eq(buckets[0], {3, 0});
+  expect_forward_eq(buckets[1], {4, 1});
+}
+
+TEST(advanced_intrusive_list_head_testing, normal_mode_plain_hook) {
+  struct plain_node
+      : intrusive::list_element<intrusive::default_tag,
+                                intrusive::link_mode::normal> {
+    explicit plain_node(int value) : value(value) {}
+
+    int value;
+  };
+  plain_node a(1), b(2), c(3);
+  intrusive::list_head<plain_node> head;
+  head.push_front(c);
+  head.push_front(b);
+  head.push_front(a);
+  intrusive::list_head<plain_node>::unlink(a);
+  intrusive::list_head<plain_node>::unlink(c);
+  expect_forward_eq(head, {2});
+  head.clear();
+  EXPECT_TRUE(head.empty());
+}
+
+TEST(advanced_intrusive_list_head_testing, plain_hooks_unaffected) {
+  static_assert(!intrusive::list_element<>::head_aware);
+  static_assert(intrusive::list_head_element<>::head_aware);
+  static_assert(std::is_same_v<intrusive::list<head_node>::hook_type,
+                               intrusive::list_head_element<>>);
+  // a list_head_element may go from a list_head to a list and back
+  head_node a(1), b(2);
+  intrusive::list_head<head_node> head;
+  intrusive::list<head_node> list;
+  head.push_front(b);
+  head.push_front(a);
+  list.insert(list.end(), a);
+  expect_forward_eq(head, {2});
+  expect_eq(list, {1});
+  list.pop_front();
+  head.push_front(a);
+  expect_forward_eq(head, {1, 2});
+}
+
+struct xor_node : intrusive::xor_list_element<> {
+  explicit xor_node(int value) : value(value) {}
+
+  int value;
+};
+
+TEST(advanced_intrusive_xor_list_testing, hook_size) {
+  static_assert(sizeof(intrusive::xor_list_element<>) == sizeof(void*));
+  intrusive::xor_list<xor_node> list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_TRUE(list.begin() == list.end());
+}
+
+TEST(advanced_intrusive_xor_list_testing, ends) {
+  xor_node a(1), b(2), c(3), d(4);
+  intrusive::xor_list<xor_node> list;
+  list.push_back(b);
+  list.push_front(a);
+  list.push_back(c);
+  list.push_front(d);
+  expect_eq(list, {4, 1, 2, 3});
+  EXPECT_EQ(4, list.front().value);
+  EXPECT_EQ(3, std::as_const(list).back().value);
+  list.pop_front();
+  list.pop_back();
+  expect_eq(list, {1, 2});
+  list.pop_back();
+  list.pop_back();
+  EXPECT_TRUE(list.empty());
+  list.push_back(c);
+  expect_eq(list, {3});
+}
+
+TEST(advanced_intrusive_xor_list_testing, insert_erase) {
+  xor_node a(1), b(2), c(3), d(4);
+  intrusive::xor_list<xor_node> list;
+  mass_push_back(list, a, c);
+  auto it = list.insert(std::next(list.begin()), b);
+  EXPECT_EQ(2, it->value);
+  EXPECT_EQ(3, std::next(it)->value);
+  EXPECT_EQ(1, std::prev(it)->value);
+  list.insert(list.end(), d);
+  expect_eq(list, {1, 2, 3, 4});
+
+  it = list.erase(std::next(list.begin()));
+  EXPECT_EQ(3, it->value);
+  it = list.erase(it);
+  EXPECT_EQ(4, it->value);
+  EXPECT_EQ(1, std::prev(it)->value);
+  it = list.erase(it);
+  EXPECT_TRUE(it == list.end());
+  expect_eq(list, {1});
+  list.clear();
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(advanced_intrusive_xor_list_testing, splice) {
+  xor_node a(1), b(2), c(3), d(4), e(5), f(6);
+  intrusive::xor_list<xor_node> l1, l2, l3;
+  mass_push_back(l1, a, b);
+  mass_push_back(l2, c, d);
+  l1.splice(std::next(l1.begin()), l2);
+  expect_eq(l1, {1, 3, 4, 2});
+  EXPECT_TRUE(l2.empty());
+  mass_push_back(l2, e);
+  l1.splice(l1.begin(), l2);
+  expect_eq(l1, {5, 1, 3, 4, 2});
+  mass_push_back(l2, f);
+  l1.splice(l1.end(), l2);
+  expect_eq(l1, {5, 1, 3, 4, 2, 6});
+  l3.splice(l3.end(), l1);
+  EXPECT_TRUE(l1.empty());
+  expect_eq(l3, {5, 1, 3, 4, 2, 6});
+  l3.clear();
+}
+
+TEST(advanced_intrusive_xor_list_testing, reverse_move) {
+  xor_node a(1), b(2), c(3), d(4);
+  intrusive::xor_list<xor_node> list1;
+  mass_push_back(list1, a, b, c);
+  list1.reverse();
+  expect_eq(list1, {3, 2, 1});
+  list1.push_back(d);
+  expect_eq(list1, {3, 2, 1, 4});
+  intrusive::xor_list<xor_node> list2 = std::move(list1);
+  EXPECT_TRUE(list1.empty());
+  expect_eq(list2, {3, 2, 1, 4});
+  list1 = std::move(list2);
+  EXPECT_TRUE(list2.empty());
+  expect_eq(list1, {3, 2, 1, 4});
+  list1.clear();
+}
+
+struct tagged_node : intrusive::tagged_list_element<> {
+  explicit tagged_node(int value) : value(value) {}
+
+  int value;
+};
+
+TEST(advanced_intrusive_tagged_list_testing, hook_size) {
+  struct plain_object : intrusive::list_element<> {
+    void* payload;
+    bool dirty;
+    bool pinned;
+  };
+  struct tagged_object : intrusive::tagged_list_element<> {
+    void* payload;
+  };
+  static_assert(sizeof(intrusive::tagged_list_element<>) ==
+                sizeof(intrusive::list_element<>));
+  static_assert(sizeof(tagged_object) + sizeof(void*) ==
+                sizeof(plain_object));
+  intrusive::tagged_list<tagged_node> list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_TRUE(list.begin() == list.end());
+}
+
+TEST(advanced_intrusive_tagged_list_testing, flags) {
+  tagged_node a(1);
+  EXPECT_EQ(0u, a.flags());
+  a.set_flag(1);
+  EXPECT_FALSE(a.flag(0));
+  EXPECT_TRUE(a.flag(1));
+  a.set_flags(3);
+  EXPECT_EQ(3u, a.flags());
+  a.set_flag(0, false);
+  EXPECT_EQ(2u, a.flags());
+
+  intrusive::tagged_list_element<struct wide_tag, 3> wide;
+  wide.set_flags(7);
+  EXPECT_EQ(7u, wide.flags());
+}
+
+TEST(advanced_intrusive_tagged_list_testing, flags_survive_linking) {
+  tagged_node a(1), b(2), c(3);
+  a.set_flags(1);
+  b.set_flags(2);
+  c.set_flags(3);
+  intrusive::tagged_list<tagged_node> list;
+  mass_push_back(list, a, b, c);
+  expect_eq(list, {1, 2, 3});
+  EXPECT_EQ(1u, a.flags());
+  EXPECT_EQ(2u, b.flags());
+  EXPECT_EQ(3u, c.flags());
+
+  b.set_flags(0);
+  expect_eq(list, {1, 2, 3});
+  list.erase(list.iterator_to(b));
+  expect_eq(list, {1, 3});
+  EXPECT_EQ(1u, a.flags());
+  EXPECT_EQ(3u, c.flags());
+  list.push_front(b);
+  expect_eq(list, {2, 1, 3});
+  EXPECT_EQ(0u, b.flags());
+}
+
+TEST(advanced_intrusive_tagged_list_testing, ends) {
+  tagged_node a(1), b(2), c(3), d(4);
+  intrusive::tagged_list<tagged_node> list;
+  list.push_back(b);
+  list.push_front(a);
+  list.push_back(c);
+  list.push_front(d);
+  expect_eq(list, {4, 1, 2, 3});
+  EXPECT_EQ(4, list.front().value);
+  EXPECT_EQ(3, std::as_const(list).back().value);
+  list.pop_front();
+  list.pop_back();
+  expect_eq(list, {1, 2});
+  list.clear();
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(advanced_intrusive_tagged_list_testing, auto_unlink) {
+  tagged_node a(1), c(3);
+  intrusive::tagged_list<tagged_node> list;
+  a.set_flags(3);
+  {
+    tagged_node b(2);
+    mass_push_back(list, a, b, c);
+    expect_eq(list, {1, 2, 3});
+  }
+  expect_eq(list, {1, 3});
+  EXPECT_EQ(3u, a.flags());
+}
+
+TEST(advanced_intrusive_tagged_list_testing, copy_move_element) {
+  tagged_node a(1), b(2);
+  a.set_flags(2);
+  intrusive::tagged_list<tagged_node> list;
+  mass_push_back(list, a, b);
+  tagged_node copy = a;
+  EXPECT_EQ(2u, copy.flags());
+  expect_eq(list, {1, 2});
+  tagged_node moved = std::move(a);
+  EXPECT_EQ(2u, moved.flags());
+  expect_eq(list, {1, 2});
+  EXPECT_TRUE(list.begin() == list.iterator_to(moved));
+}
+
+TEST(advanced_intrusive_tagged_list_testing, splice_move) {
+  tagged_node a(1), b(2), c(3), d(4);
+  intrusive::tagged_list<tagged_node> list1, list2;
+  mass_push_back(list1, a, b);
+  mass_push_back(list2, c, d);
+  d.set_flags(1);
+  list1.splice(std::next(list1.begin()), list2);
+  expect_eq(list1, {1, 3, 4, 2});
+  EXPECT_TRUE(list2.empty());
+  EXPECT_EQ(1u, d.flags());
+  list2 = std::move(list1);
+  EXPECT_TRUE(list1.empty());
+  expect_eq(list2, {1, 3, 4, 2});
+  intrusive::tagged_list<tagged_node> list3 = std::move(list2);
+  expect_eq(list3, {1, 3, 4, 2});
+}
+
+struct plain_node {
+  int value;
+};
+
+std::vector<plain_node> make_plain_nodes(int count) {
+  std::vector<plain_node> nodes;
+  for (int i = 0; i < count; ++i) {
+    nodes.push_back({i});
+  }
+  return nodes;
+}
+
+TEST(advanced_intrusive_index_list_testing, ends) {
+  auto nodes = make_plain_nodes(4);
+  intrusive::index_list<plain_node> list{nodes};
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(4u, list.capacity());
+  list.push_back(nodes[1]);
+  list.push_front(nodes[0]);
+  list.push_back(nodes[2]);
+  list.push_front(nodes[3]);
+  expect_eq(list, {3, 0, 1, 2});
+  EXPECT_EQ(4u, list.size());
+  EXPECT_EQ(3, list.front().value);
+  EXPECT_EQ(2, std::as_const(list).back().value);
+  list.pop_front();
+  list.pop_back();
+  expect_eq(list, {0, 1});
+  EXPECT_EQ(2u, list.size());
+  list.clear();
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(0u, list.size());
+}
+
+TEST(advanced_intrusive_index_list_testing, insert_erase) {
+  auto nodes = make_plain_nodes(4);
+  intrusive::index_list<plain_node> list{nodes};
+  mass_push_back(list, nodes[0], nodes[2]);
+  auto it = list.insert(list.iterator_to(nodes[2]), nodes[1]);
+  EXPECT_EQ(1u, it.slot());
+  list.insert(list.end(), nodes[3]);
+  expect_eq(list, {0, 1, 2, 3});
+
+  it = list.erase(list.iterator_to(nodes[1]));
+  EXPECT_EQ(2, it->value);
+  it = list.erase(list.iterator_to(nodes[3]));
+  EXPECT_TRUE(it == list.end());
+  expect_eq(list, {0, 2});
+  EXPECT_EQ(2u, list.size());
+  EXPECT_FALSE(list.is_linked(1));
+  EXPECT_TRUE(list.is_linked(2));
+}
+
+TEST(advanced_intrusive_index_list_testing, scans) {
+  auto nodes = make_plain_nodes(100);
+  intrusive::index_list<plain_node> list{nodes};
+  EXPECT_EQ(0u, list.find_unlinked());
+  for (int i = 0; i < 90; ++i) {
+    list.push_back(nodes[i]);
+  }
+  EXPECT_EQ(90u, list.count_linked());
+  EXPECT_EQ(90u, list.find_unlinked());
+  list.erase(list.iterator_to(nodes[37]));
+  EXPECT_EQ(37u, list.find_unlinked());
+  EXPECT_EQ(90u, list.find_unlinked(38));
+  for (int i = 90; i < 100; ++i) {
+    list.push_back(nodes[i]);
+  }
+  EXPECT_EQ(100u, list.find_unlinked(38));
+  EXPECT_EQ(99u, list.count_linked());
+  EXPECT_EQ(99u, list.size());
+}
+
+TEST(advanced_intrusive_index_list_testing, rebind) {
+  auto nodes = make_plain_nodes(3);
+  intrusive::index_list<plain_node> list{nodes};
+  mass_push_back(list, nodes[2], nodes[0]);
+  for (int i = 3; i < 1000; ++i) {
+    nodes.push_back({i});
+  }
+  list.rebind(nodes);
+  EXPECT_EQ(1000u, list.capacity());
+  expect_eq(list, {2, 0});
+  list.push_back(nodes[999]);
+  list.push_front(nodes[500]);
+  expect_eq(list, {500, 2, 0, 999});
+
+  list.erase(list.iterator_to(nodes[999]));
+  list.erase(list.iterator_to(nodes[500]));
+  nodes.resize(3);
+  nodes.shrink_to_fit();
+  list.rebind(nodes);
+  expect_eq(list, {2, 0});
+}
+
+TEST(advanced_intrusive_index_list_testing, move) {
+  auto nodes = make_plain_nodes(3);
+  intrusive::index_list<plain_node> list1{nodes};
+  mass_push_back(list1, nodes[0], nodes[1]);
+  intrusive::index_list<plain_node> list2 = std::move(list1);
+  EXPECT_TRUE(list1.empty());
+  EXPECT_EQ(0u, list1.capacity());
+  EXPECT_EQ(0u, list1.size());
+  expect_eq(list2, {0, 1});
+  EXPECT_EQ(2u, list2.size());
+  list1 = std::move(list2);
+  expect_eq(list1, {0, 1});
+  EXPECT_EQ(2u, list1.size());
+  EXPECT_TRUE(list2.empty());
+  EXPECT_EQ(0u, list2.size());
+}
+
+struct queue_node : intrusive::atomic_slist_element<> {
+  queue_node() = default;
+  explicit queue_node(int value) : value(value) {}
+
+  int value{0};
+  int producer{0};
+};
+
+TEST(advanced_intrusive_mpsc_queue_testing, fifo) {
+  queue_node a(1), b(2), c(3);
+  intrusive::mpsc_queue<queue_node> queue;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(nullptr, queue.try_pop());
+  queue.push(a);
+  queue.push(b);
+  EXPECT_FALSE(queue.empty());
+  EXPECT_EQ(&a, queue.try_pop());
+  queue.push(c);
+  EXPECT_EQ(&b, queue.try_pop());
+  EXPECT_EQ(&c, queue.try_pop());
+  EXPECT_EQ(nullptr, queue.try_pop());
+  EXPECT_TRUE(queue.empty());
+
+  // popped elements may be pushed again
+  queue.push(b);
+  queue.push(a);
+  EXPECT_EQ(&b, queue.try_pop());
+  EXPECT_EQ(&a, queue.try_pop());
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(advanced_intrusive_mpsc_queue_testing, concurrent_producers) {
+  constexpr int producers = 4;
+  constexpr int per_producer = 20000;
+  std::vector<queue_node> nodes(producers * per_producer);
+  intrusive::mpsc_queue<queue_node> queue;
+
+  std::vector<std::thread> threads;
+  for (int p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (int i = 0; i < per_producer; ++i) {
+        queue_node& n = nodes[p * per_producer + i];
+        n.value = i;
+        n.producer = p;
+        queue.push(n);
+      }
+    });
+  }
+  std::vector<int> next_expected(producers, 0);
+  for (int received = 0; received < producers * per_producer;) {
+    queue_node* n = queue.try_pop();
+    if (n == nullptr) {
+      std::this_thread::yield();
+      continue;
+    }
+    EXPECT_EQ(next_expected[n->producer], n->value);
+    next_expected[n->producer] = n->value + 1;
+    ++received;
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(nullptr, queue.try_pop());
+}
+
+TEST(advanced_intrusive_atomic_stack_testing, lifo) {
+  node a(1), b(2), c(3);
+  intrusive::atomic_stack<node> stack;
+  EXPECT_TRUE(stack.empty());
+  EXPECT_EQ(nullptr, stack.pop());
+  stack.push(a);
+  stack.push(b);
+  EXPECT_FALSE(stack.empty());
+  EXPECT_EQ(&b, stack.pop());
+  stack.push(c);
+  EXPECT_EQ(&c, stack.pop());
+  EXPECT_EQ(&a, stack.pop());
+  EXPECT_EQ(nullptr, stack.pop());
+  EXPECT_TRUE(stack.empty());
+
+  // popped elements are unlinked and may go to a list
+  intrusive::list<node> list;
+  mass_push_back(list, a, b, c);
+  expect_eq(list, {1, 2, 3});
+}
+
+TEST(advanced_intrusive_atomic_stack_testing, pop_all) {
+  node a(1), b(2), c(3);
+  intrusive::atomic_stack<node> stack;
+  EXPECT_TRUE(stack.pop_all().empty());
+  stack.push(a);
+  stack.push(b);
+  stack.push(c);
+  auto list = stack.pop_all<intrusive::constant_time_size>();
+  EXPECT_TRUE(stack.empty());
+  EXPECT_EQ(3, list.size());
+  expect_eq(list, {3, 2, 1});
+
+  list.pop_front();
+  stack.push(c);
+  EXPECT_EQ(&c, stack.pop());
+}
+
+TEST(advanced_intrusive_atomic_stack_testing, member_hook) {
+  struct item {
+    explicit item(int value) : value(value) {}
+
+    int value;
+    intrusive::list_element<> hook;
+  };
+  using tag = intrusive::member_hook<&item::hook>;
+  item a(1), b(2);
+  intrusive::atomic_stack<item, tag> stack;
+  stack.push(a);
+  stack.push(b);
+  auto list = stack.pop_all();
+  expect_eq(list, {2, 1});
+}
+
+TEST(advanced_intrusive_atomic_stack_testing, concurrent_push_pop) {
+  // every thread takes elements from a shared pool and returns them, the
+  // elements outlive the stack as the ABA protection requires
+  constexpr int threads_count = 4;
+  constexpr int pool_size = 64;
+  constexpr int rounds = 20000;
+  std::vector<node> pool;
+  pool.reserve(pool_size);
+  for (int i = 0; i < pool_size; ++i) {
+    pool.emplace_back(0);
+  }
+  intrusive::atomic_stack<node> stack;
+  for (node& n : pool) {
+    stack.push(n);
+  }
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; ++t) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < rounds; ++i) {
+        node* n = stack.pop();
+        if (n == nullptr) {
+          continue;
+        }
+        ++n->value;
+        stack.push(*n);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto list = stack.pop_all();
+  EXPECT_EQ(static_cast<std::size_t>(pool_size), list.size());
+  int total = 0;
+  for (node& n : list) {
+    total += n.value;
+  }
+  EXPECT_EQ(threads_count * rounds, total);
+  list.clear();
+}
+
+TEST(advanced_intrusive_sharded_list_testing, push_erase_pop) {
+  node a(1), b(2), c(3);
+  intrusive::sharded_list<node, intrusive::default_tag, 4> list;
+  EXPECT_TRUE(list.empty());
+  EXPECT_EQ(nullptr, list.try_pop());
+
+  std::size_t local = list.local_shard();
+  EXPECT_EQ(local, list.push(a));
+  EXPECT_EQ(1u, list.push(b, 5));
+  EXPECT_EQ(2u, list.push(c, 2));
+  EXPECT_FALSE(list.empty());
+
+  list.erase(b, 1);
+  EXPECT_EQ(&a, list.try_pop());
+  EXPECT_EQ(&c, list.try_pop());
+  EXPECT_EQ(nullptr, list.try_pop());
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(advanced_intrusive_sharded_list_testing, drain_all) {
+  node a(1), b(2), c(3), d(4);
+  intrusive::sharded_list<node, intrusive::default_tag, 4> list;
+  list.push(a, 3);
+  list.push(b, 1);
+  list.push(c, 1);
+  list.push(d, 0);
+
+  auto drained = list.drain_all();
+  EXPECT_TRUE(list.empty());
+  expect_eq(drained, {4, 2, 3, 1});
+  EXPECT_TRUE(list.drain_all().empty());
+}
+
+TEST(advanced_intrusive_sharded_list_testing, concurrent) {
+  constexpr int threads_count = 8;
+  constexpr int per_thread = 5000;
+  std::vector<node> nodes;
+  nodes.reserve(threads_count * per_thread);
+  for (int i = 0; i < threads_count * per_thread; ++i) {
+    nodes.emplace_back(i);
+  }
+  intrusive::sharded_list<node, intrusive::default_tag, 4> list;
+
+  // every thread inserts its elements and erases every other one
+  std::vector<std::thread> threads;
+  for (int t = 0; t < threads_count; ++t) {
+    threads.emplace_back([&, t] {
+      std::vector<std::size_t> shards;
+      for (int i = 0; i < per_thread; ++i) {
+        shards.push_back(list.push(nodes[t * per_thread + i]));
+      }
+      for (int i = 0; i < per_thread; i += 2) {
+        list.erase(nodes[t * per_thread + i], shards[i]);
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  auto drained = list.drain_all();
+  EXPECT_EQ(static_cast<std::size_t>(threads_count * per_thread / 2),
+            drained.size());
+  for (node& n : drained) {
+    EXPECT_EQ(1, n.value % 2);
+  }
+}
+
+struct rcu_node : intrusive::rcu_list_element<> {
+  explicit rcu_node(int value) : value(value) {}
+
+  int value;
+};
+
+TEST(advanced_intrusive_rcu_list_testing, insert_erase_reclaim) {
+  rcu_node a(1), b(2), c(3), d(4);
+  intrusive::rcu_list<rcu_node> list;
+  EXPECT_TRUE(list.empty());
+  list.push_back(b);
+  list.push_front(a);
+  list.push_back(d);
+  list.insert(list.iterator_to(d), c);
+  expect_forward_eq(list, {1, 2, 3, 4});
+
+  std::vector<int> disposed;
+  auto dispose = [&](rcu_node& n) { disposed.push_back(n.value); };
+  list.reclaim(dispose);
+  EXPECT_TRUE(disposed.empty());
+
+  list.erase(b);
+  list.erase(d);
+  expect_forward_eq(list, {1, 3});
+  list.reclaim(dispose);
+  EXPECT_EQ((std::vector<int>{4, 2}), disposed);
+
+  // reclaimed elements are unlinked and may be inserted again
+  list.push_front(d);
+  list.erase_and_dispose(a, dispose);
+  EXPECT_EQ((std::vector<int>{4, 2, 1}), disposed);
+  expect_forward_eq(list, {4, 3});
+}
+
+TEST(advanced_intrusive_rcu_list_testing, reader_on_erased_element) {
+  rcu_node a(1), b(2), c(3);
+  intrusive::rcu_list<rcu_node> list;
+  mass_push_back(list, a, b, c);
+
+  std::vector<int> seen;
+  {
+    auto guard = list.read_lock();
+    auto it = list.begin();
+    ++it;
+    // the reader stands on `b` while it's erased
+    list.erase(b);
+    list.erase(c);
+    for (; it != list.end(); ++it) {
+      seen.push_back(it->value);
+    }
+  }
+  EXPECT_EQ((std::vector<int>{2, 3}), seen);
+  expect_forward_eq(list, {1});
+  list.reclaim([](rcu_node&) {});
+  list.erase_and_dispose(a, [](rcu_node&) {});
+  EXPECT_TRUE(list.empty());
+}
+
+TEST(advanced_intrusive_rcu_list_testing, concurrent_readers) {
+  // the writer keeps replacing elements and poisons the reclaimed ones,
+  // readers must never reach a poisoned element
+  constexpr int readers_count = 4;
+  constexpr int slots = 8;
+  constexpr int rounds = 2000;
+  std::vector<std::unique_ptr<rcu_node>> nodes;
+  intrusive::rcu_list<rcu_node> list;
+  for (int i = 0; i < slots; ++i) {
+    nodes.push_back(std::make_unique<rcu_node>(i));
+    list.push_back(*nodes.back());
+  }
+
+  std::atomic<bool> done{false};
+  std::atomic<int> poisoned_seen{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < readers_count; ++r) {
+    readers.emplace_back([&] {
+      while (!done.load(std::memory_order_relaxed)) {
+        auto guard = list.read_lock();
+        for (const rcu_node& n : list) {
+          if (n.value < 0) {
+            poisoned_seen.fetch_add(1, std::memory_order_relaxed);
+          }
+        }
+      }
+    });
+  }
+
+  std::vector<std::unique_ptr<rcu_node>> spare;
+  for (int i = 0; i < rounds; ++i) {
+    auto& victim = nodes[i % slots];
+    std::unique_ptr<rcu_node> replacement;
+    if (spare.empty()) {
+      replacement = std::make_unique<rcu_node>(0);
+    } else {
+      replacement = std::move(spare.back());
+      spare.pop_back();
+    }
+    replacement->value = i;
+    list.insert(list.iterator_to(*victim), *replacement);
+    list.erase_and_dispose(*victim, [](rcu_node& n) { n.value = -1; });
+    spare.push_back(std::exchange(victim, std::move(replacement)));
+  }
+  done.store(true, std::memory_order_relaxed);
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, poisoned_seen.load());
+}
+
+struct epoch_node : intrusive::list_element<intrusive::retire_tag> {
+  explicit epoch_node(int value) : value(value) {}
+
+  int value;
+};
+
+/// Records the values of disposed nodes
+struct recording_disposer {
+  void operator()(epoch_node& n) {
+    disposed->push_back(n.value);
+  }
+
+  std::vector<int>* disposed;
+};
+
+TEST(advanced_intrusive_epoch_testing, retire_reclaim) {
+  epoch_node a(1), b(2), c(3);
+  std::vector<int> disposed;
+  intrusive::epoch_domain domain;
+  {
+    intrusive::epoch_handle<epoch_node, recording_disposer> handle{
+        domain, recording_disposer{&disposed}, 100};
+    {
+      auto guard = handle.pin();
+      EXPECT_TRUE(handle.is_pinned());
+      handle.retire(a);
+      handle.retire(b);
+      // the thread itself keeps the epoch from advancing twice
+      handle.reclaim();
+      handle.reclaim();
+      EXPECT_TRUE(disposed.empty());
+    }
+    EXPECT_FALSE(handle.is_pinned());
+    EXPECT_EQ(2u, handle.retired_count());
+    handle.reclaim();
+    EXPECT_EQ((std::vector<int>{1, 2}), disposed);
+    EXPECT_EQ(0u, handle.retired_count());
+
+    // left over nodes are disposed of when the handle goes away
+    handle.retire(c);
+  }
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), disposed);
+}
+
+TEST(advanced_intrusive_epoch_testing, pinned_thread_blocks_reclaim) {
+  epoch_node a(1);
+  std::vector<int> disposed;
+  intrusive::epoch_domain domain;
+  intrusive::epoch_handle<epoch_node, recording_disposer> reader{domain};
+  intrusive::epoch_handle<epoch_node, recording_disposer> writer{
+      domain, recording_disposer{&disposed}};
+  {
+    auto guard = reader.pin();
+    writer.retire(a);
+    for (int i = 0; i < 5; ++i) {
+      writer.reclaim();
+    }
+    EXPECT_TRUE(disposed.empty());
+  }
+  writer.reclaim_all();
+  EXPECT_EQ((std::vector<int>{1}), disposed);
+}
+
+TEST(advanced_intrusive_epoch_testing, threshold) {
+  std::vector<std::unique_ptr<epoch_node>> nodes;
+  std::vector<int> disposed;
+  intrusive::epoch_domain domain;
+  intrusive::epoch_handle<epoch_node, recording_disposer> handle{
+      domain, recording_disposer{&disposed}, 4};
+  for (int i = 0; i < 100; ++i) {
+    nodes.push_back(std::make_unique<epoch_node>(i));
+    handle.retire(*nodes.back());
+    EXPECT_LE(handle.retired_count(), 3u * 4u);
+  }
+  handle.reclaim_all();
+  EXPECT_EQ(100u, disposed.size());
+}
+
+TEST(advanced_intrusive_epoch_testing, concurrent_readers) {
+  // the writer keeps replacing the published node and poisons the disposed
+  // ones, pinned readers must never see a poisoned node
+  constexpr int readers_count = 4;
+  constexpr int rounds = 20000;
+  std::vector<std::unique_ptr<epoch_node>> pool;
+  std::vector<epoch_node*> free_nodes;
+  for (int i = 0; i < 64; ++i) {
+    pool.push_back(std::make_unique<epoch_node>(0));
+    free_nodes.push_back(pool.back().get());
+  }
+  struct poisoning_disposer {
+    void operator()(epoch_node& n) {
+      n.value = -1;
+      free_nodes->push_back(&n);
+    }
+
+    std::vector<epoch_node*>* free_nodes;
+  };
+
+  intrusive::epoch_domain domain;
+  epoch_node first(0);
+  std::atomic<epoch_node*> current{&first};
+  std::atomic<bool> done{false};
+  std::atomic<int> poisoned_seen{0};
+  std::vector<std::thread> readers;
+  for (int r = 0; r < readers_count; ++r) {
+    readers.emplace_back([&] {
+      intrusive::epoch_handle<epoch_node, poisoning_disposer> handle{domain};
+      while (!done.load(std::memory_order_relaxed)) {
+        auto guard = handle.pin();
+        if (current.load(std::memory_order_acquire)->value < 0) {
+          poisoned_seen.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+    });
+  }
+  {
+    intrusive::epoch_handle<epoch_node, poisoning_disposer> handle{
+        domain, poisoning_disposer{&free_nodes}, 8};
+    for (int i = 1; i <= rounds; ++i) {
+      while (free_nodes.empty()) {
+        handle.reclaim();
+        std::this_thread::yield();
+      }
+      epoch_node* next = free_nodes.back();
+      free_nodes.pop_back();
+      next->value = i;
+      epoch_node* old = current.exchange(next, std::memory_order_acq_rel);
+      if (old != &first) {
+        handle.retire(*old);
+      }
+    }
+    done.store(true, std::memory_order_relaxed);
+    for (auto& reader : readers) {
+      reader.join();
+    }
+  }
+  EXPECT_EQ(0, poisoned_seen.load());
+  EXPECT_EQ(pool.size() - 1, free_nodes.size());
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <limits>
+#include <string_view>
+#include <utility>
+
+// Substring of benchmark names to run, empty means "run everything"
+inline std::string_view benchmark_filter;
+
+template <typename T>
+void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static_cast<void>(value);
+#endif
+}
+
+/// Runs `body` a few times and reports the best time per one of `ops`
+/// operations performed by a single run. `setup` is called untimed before
+/// every run
+template <typename S, typename F>
+void run_benchmark(std::string_view name, std::size_t ops, S&& setup,
+                   F&& body) {
+  if (name.find(benchmark_filter) == std::string_view::npos) {
+    return;
+  }
+  constexpr int repetitions = 5;
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repetitions; ++i) {
+    setup();
+    auto start = std::chrono::steady_clock::now();
+    body();
+    std::chrono::duration<double, std::nano> elapsed =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, elapsed.count());
+  }
+  std::printf("%-56.*s %10.2f ns/op\n", static_cast<int>(name.size()),
+              name.data(), best / static_cast<double>(ops));
+}
+
+template <typename F>
+void run_benchmark(std::string_view name, std::size_t ops, F&& body) {
+  run_benchmark(name, ops, [] {}, std::forward<F>(body));
+}
@@ -0,0 +1,1068 @@
+#include "bench_utils.h"
+#include "intrusive_atomic_stack.h"
+#include "intrusive_epoch.h"
+#include "intrusive_index_list.h"
+#include "intrusive_list.h"
+#include "intrusive_list_algorithms.h"
+#include "intrusive_list_head.h"
+#include "intrusive_mpsc_queue.h"
+#include "intrusive_offset_list.h"
+#include "intrusive_rcu_list.h"
+#include "intrusive_sharded_list.h"
+#include "intrusive_xor_list.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct bench_node : intrusive::list_element<> {
+  explicit bench_node(std::size_t value) : value(value) {}
+
+  std::size_t value;
+};
+
+struct normal_bench_node
+    : intrusive::list_element<intrusive::default_tag,
+                              intrusive::link_mode::normal> {
+  explicit normal_bench_node(std::size_t value) : value(value) {}
+
+  std::size_t value;
+};
+
+struct head_bench_node : intrusive::list_head_element<> {
+  explicit head_bench_node(std::size_t value) : value(value) {}
+
+  std::size_t value;
+};
+
+struct offset_bench_node : intrusive::offset_list_element<> {
+  explicit offset_bench_node(std::size_t value) : value(value) {}
+
+  std::size_t value;
+};
+
+struct xor_bench_node : intrusive::xor_list_element<> {
+  explicit xor_bench_node(std::size_t value) : value(value) {}
+
+  std::size_t value;
+};
+
+template <typename Node = bench_node>
+std::vector<Node> make_nodes(std::size_t count) {
+  std::vector<Node> nodes;
+  nodes.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    nodes.emplace_back(i);
+  }
+  return nodes;
+}
+
+/// Random permutation of [0, count), used to link nodes out of address order
+std::vector<std::size_t> shuffled_indices(std::size_t count) {
+  std::vector<std::size_t> indices(count);
+  std::iota(indices.begin(), indices.end(), std::size_t{0});
+  std::shuffle(indices.begin(), indices.end(), std::mt19937_64{42});
+  return indices;
+}
+
+/// Node of the baseline for the push/erase benches: the list primitives as
+/// they were before becoming header-only, compiled out of line so that
+/// every call is opaque to the optimizer
+struct out_of_line_node {
+  explicit out_of_line_node(std::size_t value_ = 0) : value(value_) {}
+
+  out_of_line_node* prev{this};
+  out_of_line_node* next{this};
+  std::size_t value;
+};
+
+[[gnu::noinline]] void out_of_line_unlink(out_of_line_node& node) {
+  node.prev->next = node.next;
+  node.next->prev = node.prev;
+  node.prev = node.next = &node;
+}
+
+/// Inserts `other` before `pos`
+[[gnu::noinline]] void out_of_line_insert(out_of_line_node& pos,
+                                          out_of_line_node& other) {
+  if (&pos == &other) {
+    return;
+  }
+  out_of_line_unlink(other);
+  pos.prev->next = &other;
+  other.prev = pos.prev;
+  other.next = &pos;
+  pos.prev = &other;
+}
+
+void bench_push_erase() {
+  constexpr std::size_t count = 1 << 16;
+  auto nodes = make_nodes(count);
+  auto baseline_nodes = make_nodes<out_of_line_node>(count);
+
+  run_benchmark("list/push_back+pop_front (out-of-line baseline)", count,
+                [&] {
+                  out_of_line_node sentinel;
+                  for (auto& n : baseline_nodes) {
+                    out_of_line_insert(sentinel, n);
+                  }
+                  while (sentinel.next != &sentinel) {
+                    out_of_line_unlink(*sentinel.next);
+                  }
+                  do_not_optimize(sentinel);
+                });
+
+  run_benchmark("list/push_back+pop_front", count, [&] {
+    intrusive::list<bench_node> list;
+    for (auto& n : nodes) {
+      list.push_back(n);
+    }
+    while (!list.empty()) {
+      list.pop_front();
+    }
+    do_not_optimize(list);
+  });
+
+  run_benchmark("list/push_front+erase (out-of-line baseline)", count, [&] {
+    out_of_line_node sentinel;
+    for (auto& n : baseline_nodes) {
+      out_of_line_insert(*sentinel.next, n);
+    }
+    for (out_of_line_node* node = sentinel.next; node != &sentinel;) {
+      out_of_line_node* next = node->next;
+      out_of_line_unlink(*node);
+      node = next;
+    }
+    do_not_optimize(sentinel);
+  });
+
+  run_benchmark("list/push_front+erase", count, [&] {
+    intrusive::list<bench_node> list;
+    for (auto& n : nodes) {
+      list.push_front(n);
+    }
+    for (auto it = list.begin(); it != list.end();) {
+      it = list.erase(it);
+    }
+    do_not_optimize(list);
+  });
+}
+
+template <typename Node>
+void bench_clear_one(std::string_view name) {
+  constexpr std::size_t count = 1 << 20;
+  auto nodes = make_nodes<Node>(count);
+  intrusive::list<Node> list;
+
+  run_benchmark(name, count, [&] {
+    for (auto& n : nodes) {
+      list.push_back(n);
+    }
+    list.clear();
+    do_not_optimize(list);
+  });
+}
+
+void bench_clear() {
+  bench_clear_one<bench_node>("list/push_back+clear (link_mode::safe)");
+  bench_clear_one<normal_bench_node>(
+      "list/push_back+clear (link_mode::normal)");
+}
+
+template <typename List, typename Node>
+void bench_list_layout(std::string_view layout, List& list,
+                       std::vector<Node>& nodes) {
+  auto order = shuffled_indices(nodes.size());
+  for (std::size_t i : order) {
+    list.push_back(nodes[i]);
+  }
+
+  run_benchmark(std::string(layout) + "/traverse", nodes.size(), [&] {
+    std::size_t sum = 0;
+    for (auto& n : list) {
+      sum += n.value;
+    }
+    do_not_optimize(sum);
+  });
+
+  run_benchmark(std::string(layout) + "/erase+insert", nodes.size(), [&] {
+    // rotates the whole list by one element per step
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+      auto& n = list.front();
+      list.erase(list.begin());
+      list.insert(list.end(), n);
+    }
+    do_not_optimize(list);
+  });
+  list.clear();
+}
+
+void bench_offset_list() {
+  constexpr std::size_t count = 1 << 20;
+  {
+    auto nodes = make_nodes(count);
+    intrusive::list<bench_node> list;
+    bench_list_layout("list", list, nodes);
+  }
+  {
+    auto nodes = make_nodes<offset_bench_node>(count);
+    intrusive::offset_list<offset_bench_node> list(nodes.data());
+    bench_list_layout("offset_list", list, nodes);
+  }
+}
+
+void bench_sort() {
+  auto less = [](const bench_node& l, const bench_node& r) {
+    return l.value < r.value;
+  };
+
+  for (std::size_t count : {std::size_t{1} << 10, std::size_t{1} << 16,
+                            std::size_t{1} << 20, std::size_t{10'000'000}}) {
+    std::vector<bench_node> nodes;
+    nodes.reserve(count);
+    std::mt19937_64 gen{count};
+    for (std::size_t i = 0; i < count; ++i) {
+      nodes.emplace_back(gen());
+    }
+    auto order = shuffled_indices(count);
+    intrusive::list<bench_node> list;
+    auto relink = [&] {
+      list.clear();
+      for (std::size_t i : order) {
+        list.push_back(nodes[i]);
+      }
+    };
+    std::string size = std::to_string(count);
+
+    run_benchmark("list/sort/" + size, count, relink, [&] {
+      list.sort(less);
+      do_not_optimize(list);
+    });
+
+    run_benchmark("list/radix_sort/" + size, count, relink, [&] {
+      intrusive::radix_sort(list, [](const bench_node& n) { return n.value; });
+      do_not_optimize(list);
+    });
+
+    run_benchmark("list/radix_sort(32-bit key)/" + size, count, relink, [&] {
+      intrusive::radix_sort(list, [](const bench_node& n) {
+        return static_cast<std::uint32_t>(n.value);
+      });
+      do_not_optimize(list);
+    });
+
+    run_benchmark("list/sort_via_vector/" + size, count, relink, [&] {
+      std::vector<bench_node*> pointers;
+      for (auto& n : list) {
+        pointers.push_back(&n);
+      }
+      std::sort(pointers.begin(), pointers.end(),
+                [&](bench_node* l, bench_node* r) { return less(*l, *r); });
+      list.clear();
+      for (bench_node* n : pointers) {
+        list.push_back(*n);
+      }
+      do_not_optimize(list);
+    });
+    list.clear();
+  }
+}
+
+void bench_dispose() {
+  constexpr std::size_t count = 1 << 20;
+  auto nodes = make_nodes(count);
+  auto order = shuffled_indices(count);
+  intrusive::list<bench_node> list;
+  std::vector<bench_node*> pool;
+  pool.reserve(count);
+  auto refill = [&] {
+    pool.clear();
+    list.clear();
+    for (std::size_t i : order) {
+      list.push_back(nodes[i]);
+    }
+  };
+
+  run_benchmark("list/drain (pop_front loop)", count, refill, [&] {
+    while (!list.empty()) {
+      bench_node& n = list.front();
+      list.pop_front();
+      pool.push_back(&n);
+    }
+    do_not_optimize(pool);
+  });
+
+  run_benchmark("list/drain (clear_and_dispose)", count, refill, [&] {
+    list.clear_and_dispose([&](bench_node& n) { pool.push_back(&n); });
+    do_not_optimize(pool);
+  });
+  list.clear();
+}
+
+void bench_insert_range() {
+  constexpr std::size_t count = 1 << 20;
+  constexpr std::size_t batch = 1024;
+  auto nodes = make_nodes(count);
+  intrusive::list<bench_node> list;
+  auto reset = [&] { list.clear(); };
+
+  run_benchmark("list/enqueue batches (push_back)", count, reset, [&] {
+    for (auto& n : nodes) {
+      list.push_back(n);
+    }
+    do_not_optimize(list);
+  });
+
+  run_benchmark("list/enqueue batches (range insert)", count, reset, [&] {
+    for (std::size_t i = 0; i < count; i += batch) {
+      list.insert(list.end(), nodes.begin() + i, nodes.begin() + i + batch);
+    }
+    do_not_optimize(list);
+  });
+  list.clear();
+}
+
+template <typename Bucket>
+void bench_bucket_lookup(std::string_view name) {
+  constexpr std::size_t bucket_bits = 22;
+  constexpr std::size_t count = std::size_t{1} << (bucket_bits - 2);
+  constexpr std::size_t lookups = 1 << 22;
+  auto bucket_of = [](std::size_t key) {
+    return (key * 0x9E3779B97F4A7C15ull) >> (64 - bucket_bits);
+  };
+  auto nodes = make_nodes<head_bench_node>(count);
+  std::vector<Bucket> buckets(std::size_t{1} << bucket_bits);
+  for (auto& n : nodes) {
+    buckets[bucket_of(n.value)].push_front(n);
+  }
+  std::vector<std::size_t> keys(lookups);
+  std::mt19937_64 rng{7};
+  for (auto& key : keys) {
+    // half of the lookups miss
+    key = rng() % (2 * count);
+  }
+
+  run_benchmark(name, lookups, [&] {
+    std::size_t found = 0;
+    for (std::size_t key : keys) {
+      for (auto& n : buckets[bucket_of(key)]) {
+        if (n.value == key) {
+          ++found;
+          break;
+        }
+      }
+    }
+    do_not_optimize(found);
+  });
+}
+
+void bench_buckets() {
+  bench_bucket_lookup<intrusive::list<head_bench_node>>(
+      "buckets/lookup (list, 16-byte buckets)");
+  bench_bucket_lookup<intrusive::list_head<head_bench_node>>(
+      "buckets/lookup (list_head, 8-byte buckets)");
+}
+
+template <typename List, typename Node>
+void bench_hook_layout(std::string_view hook, std::string_view order,
+                       const std::vector<std::size_t>& indices,
+                       std::vector<Node>& nodes) {
+  std::string prefix = "hooks/" + std::string{hook} + " " +
+                       std::to_string(sizeof(Node)) + "B/node, " +
+                       std::string{order};
+  List list;
+  for (std::size_t i : indices) {
+    list.push_back(nodes[i]);
+  }
+  run_benchmark(prefix + " forward walk", nodes.size(), [&] {
+    std::size_t sum = 0;
+    for (auto& n : list) {
+      sum += n.value;
+    }
+    do_not_optimize(sum);
+  });
+  run_benchmark(prefix + " backward walk", nodes.size(), [&] {
+    std::size_t sum = 0;
+    for (auto it = list.end(); it != list.begin();) {
+      sum += (--it)->value;
+    }
+    do_not_optimize(sum);
+  });
+  run_benchmark(prefix + " rotate", nodes.size(), [&] {
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+      auto& n = list.front();
+      list.pop_front();
+      list.push_back(n);
+    }
+    do_not_optimize(list);
+  });
+  list.clear();
+}
+
+void bench_xor_list() {
+  constexpr std::size_t count = 1 << 22;
+  auto nodes = make_nodes(count);
+  auto xor_nodes = make_nodes<xor_bench_node>(count);
+  std::vector<std::size_t> sequential(count);
+  std::iota(sequential.begin(), sequential.end(), std::size_t{0});
+  auto shuffled = shuffled_indices(count);
+
+  using list = intrusive::list<bench_node>;
+  using xor_list = intrusive::xor_list<xor_bench_node>;
+  bench_hook_layout<list>("list_element", "sequential", sequential, nodes);
+  bench_hook_layout<xor_list>("xor_list_element", "sequential", sequential,
+                              xor_nodes);
+  bench_hook_layout<list>("list_element", "shuffled", shuffled, nodes);
+  bench_hook_layout<xor_list>("xor_list_element", "shuffled", shuffled,
+                              xor_nodes);
+}
+
+struct plain_bench_node {
+  std::size_t value;
+};
+
+void bench_index_list_order(std::string_view order,
+                            const std::vector<std::size_t>& indices) {
+  std::size_t count = indices.size();
+  auto nodes = make_nodes(count);
+  std::vector<plain_bench_node> plain_nodes(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    plain_nodes[i].value = i;
+  }
+  intrusive::list<bench_node> list;
+  intrusive::index_list<plain_bench_node> index_list{plain_nodes};
+  for (std::size_t i : indices) {
+    list.push_back(nodes[i]);
+    index_list.push_back(plain_nodes[i]);
+  }
+  std::string suffix = ", " + std::string{order} + ")";
+
+  auto walk = [](auto& l) {
+    std::size_t sum = 0;
+    for (auto& n : l) {
+      sum += n.value;
+    }
+    do_not_optimize(sum);
+  };
+  run_benchmark("index_list/walk (list" + suffix, count, [&] { walk(list); });
+  run_benchmark("index_list/walk (index_list" + suffix, count,
+                [&] { walk(index_list); });
+  run_benchmark("index_list/count (list.size" + suffix, count,
+                [&] { do_not_optimize(list.size()); });
+  run_benchmark("index_list/count (index_list.count_linked" + suffix, count,
+                [&] { do_not_optimize(index_list.count_linked()); });
+  list.clear();
+}
+
+void bench_index_list() {
+  constexpr std::size_t count = 1 << 22;
+  std::vector<std::size_t> sequential(count);
+  std::iota(sequential.begin(), sequential.end(), std::size_t{0});
+  bench_index_list_order("sequential", sequential);
+  bench_index_list_order("shuffled", shuffled_indices(count));
+}
+
+void bench_relayout() {
+  constexpr std::size_t count = 1 << 20;
+  std::vector<std::unique_ptr<bench_node>> owned;
+  owned.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    owned.push_back(std::make_unique<bench_node>(i));
+  }
+  intrusive::list<bench_node> list;
+  for (auto& n : owned) {
+    list.push_back(*n);
+  }
+  // list order unrelated to address order, as after hours of LRU churn
+  std::mt19937_64 rng{42};
+  auto scatter = [&] {
+    std::vector<bench_node*> order;
+    for (auto& n : list) {
+      order.push_back(&n);
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    list.clear();
+    for (bench_node* n : order) {
+      list.push_back(*n);
+    }
+  };
+  auto walk = [&] {
+    std::size_t sum = 0;
+    for (auto& n : list) {
+      sum += n.value;
+    }
+    do_not_optimize(sum);
+  };
+  scatter();
+  run_benchmark("relayout/walk scattered list", count, walk);
+
+  // every run relocates the whole list, old copies are simply abandoned
+  std::pmr::monotonic_buffer_resource arena;
+  bool relaid_out = false;
+  run_benchmark("relayout/relayout scattered list", count, scatter, [&] {
+    intrusive::relayout(list, arena, [](bench_node&) {});
+    relaid_out = true;
+  });
+  run_benchmark("relayout/walk relaid out list", count, walk);
+  // only arena copies are destroyed here: when the relayout run is filtered
+  // out the list still holds the heap nodes, which `owned` frees
+  if (relaid_out) {
+    list.clear_and_dispose([](bench_node& n) { n.~bench_node(); });
+  }
+  list.clear();
+}
+
+/// Some arithmetic per element for the prefetch benchmarks, roughly what a
+/// hash table rehash or a checksum does
+std::size_t mix(std::size_t value) {
+  for (int i = 0; i < 4; ++i) {
+    value ^= value >> 31;
+    value *= 0x9E3779B97F4A7C15ull;
+  }
+  return value;
+}
+
+template <typename Body>
+void bench_prefetch_body(std::string_view body_name, Body body,
+                         intrusive::list<bench_node>& list,
+                         std::size_t count) {
+  std::string suffix = ", " + std::string{body_name} + ")";
+  run_benchmark("prefetch/walk (plain" + suffix, count, [&] {
+    std::size_t sum = 0;
+    for (auto& n : list) {
+      sum += body(n.value);
+    }
+    do_not_optimize(sum);
+  });
+  for (std::size_t distance : {2, 4, 8}) {
+    run_benchmark("prefetch/walk (for_each_prefetch " +
+                      std::to_string(distance) + suffix,
+                  count, [&] {
+                    std::size_t sum = 0;
+                    intrusive::for_each_prefetch(
+                        list, [&](bench_node& n) { sum += body(n.value); },
+                        distance);
+                    do_not_optimize(sum);
+                  });
+  }
+  run_benchmark("prefetch/walk (prefetching_iterator 4" + suffix, count, [&] {
+    using iterator =
+        intrusive::prefetching_iterator<intrusive::list<bench_node>::iterator>;
+    std::size_t sum = 0;
+    for (iterator it{list.begin(), list.end()}, end{list.end(), list.end()};
+         it != end; ++it) {
+      sum += body(it->value);
+    }
+    do_not_optimize(sum);
+  });
+}
+
+void bench_prefetch() {
+  // much larger than the LLC
+  constexpr std::size_t count = 1 << 22;
+  auto nodes = make_nodes(count);
+  intrusive::list<bench_node> list;
+  for (std::size_t i : shuffled_indices(count)) {
+    list.push_back(nodes[i]);
+  }
+  bench_prefetch_body("sum", [](std::size_t v) { return v; }, list, count);
+  bench_prefetch_body("mix", mix, list, count);
+  list.clear();
+}
+
+template <std::size_t Width>
+void bench_interleaved_width(
+    const std::vector<intrusive::list<bench_node>*>& lists,
+    std::size_t count) {
+  run_benchmark("interleave/sweep (interleaved_for_each<" +
+                    std::to_string(Width) + ">)",
+                count, [&] {
+                  std::size_t sum = 0;
+                  intrusive::interleaved_for_each<Width>(
+                      lists, [&](bench_node& n) { sum += n.value; });
+                  do_not_optimize(sum);
+                });
+}
+
+void bench_interleaved() {
+  constexpr std::size_t count = 1 << 22;
+  constexpr std::size_t list_count = 1 << 16;
+  auto nodes = make_nodes(count);
+  std::vector<intrusive::list<bench_node>> lists(list_count);
+  std::mt19937_64 rng{1};
+  for (std::size_t i : shuffled_indices(count)) {
+    lists[rng() % list_count].push_back(nodes[i]);
+  }
+  std::vector<intrusive::list<bench_node>*> pointers;
+  for (auto& l : lists) {
+    pointers.push_back(&l);
+  }
+
+  run_benchmark("interleave/sweep (one list after another)", count, [&] {
+    std::size_t sum = 0;
+    for (auto& l : lists) {
+      for (auto& n : l) {
+        sum += n.value;
+      }
+    }
+    do_not_optimize(sum);
+  });
+  bench_interleaved_width<1>(pointers, count);
+  bench_interleaved_width<4>(pointers, count);
+  bench_interleaved_width<8>(pointers, count);
+  bench_interleaved_width<16>(pointers, count);
+  bench_interleaved_width<32>(pointers, count);
+  for (auto& l : lists) {
+    l.clear();
+  }
+}
+
+void bench_erase_batch() {
+  constexpr std::size_t count = 1 << 22;
+  constexpr std::size_t victim_count = 1 << 18;
+  auto nodes = make_nodes(count);
+  auto order = shuffled_indices(count);
+  std::vector<bench_node*> victims;
+  for (std::size_t i = 0; i < victim_count; ++i) {
+    victims.push_back(&nodes[order[i]]);
+  }
+  // neighbours in the list are far apart in memory as well
+  std::shuffle(order.begin(), order.end(), std::mt19937_64{3});
+  intrusive::list<bench_node> list;
+  auto relink = [&] {
+    list.clear();
+    for (std::size_t i : order) {
+      list.push_back(nodes[i]);
+    }
+  };
+
+  run_benchmark("erase_batch/evict (erase one by one)", victim_count, relink,
+                [&] {
+                  for (bench_node* victim : victims) {
+                    list.erase(list.iterator_to(*victim));
+                  }
+                  do_not_optimize(list);
+                });
+  run_benchmark("erase_batch/evict (erase_batch)", victim_count, relink, [&] {
+    list.erase_batch(victims);
+    do_not_optimize(list);
+  });
+  list.clear();
+}
+
+struct queue_bench_node : intrusive::atomic_slist_element<>,
+                          intrusive::list_element<> {
+  std::size_t value{0};
+};
+
+/// The baseline for `mpsc_queue`: a list guarded by a mutex
+struct locked_queue {
+  void push(queue_bench_node& n) {
+    std::lock_guard lock{mutex};
+    list.push_back(n);
+  }
+
+  queue_bench_node* try_pop() {
+    std::lock_guard lock{mutex};
+    if (list.empty()) {
+      return nullptr;
+    }
+    queue_bench_node& n = list.front();
+    list.pop_front();
+    return &n;
+  }
+
+  std::mutex mutex;
+  intrusive::list<queue_bench_node> list;
+};
+
+using lock_free_queue = intrusive::mpsc_queue<queue_bench_node>;
+
+template <typename Queue>
+void bench_queue_throughput(std::string_view queue_name,
+                            std::size_t producers) {
+  constexpr std::size_t total = 1 << 20;
+  std::size_t per_producer = total / producers;
+  std::vector<queue_bench_node> nodes(per_producer * producers);
+  std::string name = "queue/throughput (" + std::string{queue_name} + ", " +
+                     std::to_string(producers) + " producers)";
+  run_benchmark(name, nodes.size(), [&] {
+    Queue queue;
+    std::vector<std::thread> threads;
+    for (std::size_t p = 0; p < producers; ++p) {
+      threads.emplace_back([&, p] {
+        for (std::size_t i = 0; i < per_producer; ++i) {
+          queue.push(nodes[p * per_producer + i]);
+        }
+      });
+    }
+    for (std::size_t received = 0; received < nodes.size();) {
+      if (queue.try_pop() != nullptr) {
+        ++received;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  });
+}
+
+/// One element bounced between two threads through two queues, reports
+/// the time of a round trip
+template <typename Queue>
+void bench_queue_round_trip(std::string_view queue_name) {
+  constexpr std::size_t trips = 1 << 14;
+  Queue ping;
+  Queue pong;
+  queue_bench_node ball;
+  auto receive = [](Queue& queue) {
+    queue_bench_node* n;
+    while ((n = queue.try_pop()) == nullptr) {
+      std::this_thread::yield();
+    }
+    return n;
+  };
+  run_benchmark("queue/round trip (" + std::string{queue_name} + ")", trips,
+                [&] {
+                  std::thread echo{[&] {
+                    for (std::size_t i = 0; i < trips; ++i) {
+                      pong.push(*receive(ping));
+                    }
+                  }};
+                  for (std::size_t i = 0; i < trips; ++i) {
+                    ping.push(ball);
+                    receive(pong);
+                  }
+                  echo.join();
+                });
+}
+
+void bench_queue() {
+  for (std::size_t producers : {1, 2, 4, 8, 32}) {
+    bench_queue_throughput<locked_queue>("mutex + list", producers);
+    bench_queue_throughput<lock_free_queue>("mpsc_queue", producers);
+  }
+  bench_queue_round_trip<locked_queue>("mutex + list");
+  bench_queue_round_trip<lock_free_queue>("mpsc_queue");
+}
+
+struct stack_bench_node : intrusive::list_element<> {
+  std::size_t value{0};
+};
+
+/// The baseline for `atomic_stack`: a list guarded by a mutex
+struct locked_stack {
+  void push(stack_bench_node& n) {
+    std::lock_guard lock{mutex};
+    list.push_front(n);
+  }
+
+  stack_bench_node* pop() {
+    std::lock_guard lock{mutex};
+    if (list.empty()) {
+      return nullptr;
+    }
+    stack_bench_node& n = list.front();
+    list.pop_front();
+    return &n;
+  }
+
+  std::mutex mutex;
+  intrusive::list<stack_bench_node> list;
+};
+
+using lock_free_stack = intrusive::atomic_stack<stack_bench_node>;
+
+/// Threads taking elements from a shared free list and giving them back,
+/// reports the time of a pop + push pair
+template <typename Stack>
+void bench_free_list(std::string_view stack_name, std::size_t threads_count) {
+  constexpr std::size_t total = 1 << 20;
+  std::size_t per_thread = total / threads_count;
+  std::vector<stack_bench_node> nodes(1024);
+  std::string name = "stack/free list (" + std::string{stack_name} + ", " +
+                     std::to_string(threads_count) + " threads)";
+  run_benchmark(name, per_thread * threads_count, [&] {
+    Stack stack;
+    for (auto& n : nodes) {
+      stack.push(n);
+    }
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_count; ++t) {
+      threads.emplace_back([&] {
+        for (std::size_t i = 0; i < per_thread; ++i) {
+          stack_bench_node* n = stack.pop();
+          ++n->value;
+          stack.push(*n);
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    while (stack.pop() != nullptr) {
+    }
+  });
+}
+
+void bench_stack() {
+  for (std::size_t threads_count : {1, 2, 4, 8, 32}) {
+    bench_free_list<locked_stack>("mutex + list", threads_count);
+    bench_free_list<lock_free_stack>("atomic_stack", threads_count);
+  }
+}
+
+/// The baseline for `sharded_list`: a single list guarded by a mutex, with
+/// the same interface
+struct locked_list {
+  std::size_t push(bench_node& n) {
+    std::lock_guard lock{mutex};
+    list.push_back(n);
+    return 0;
+  }
+
+  void erase(bench_node& n, std::size_t) {
+    std::lock_guard lock{mutex};
+    list.erase(list.iterator_to(n));
+  }
+
+  std::mutex mutex;
+  intrusive::list<bench_node> list;
+};
+
+using sharded_bench_list =
+    intrusive::sharded_list<bench_node, intrusive::default_tag, 16>;
+
+/// Threads inserting and erasing their own elements through a shared list,
+/// reports the time of an insert + erase pair
+template <typename List>
+void bench_shared_list(std::string_view list_name,
+                       std::size_t threads_count) {
+  constexpr std::size_t total = 1 << 20;
+  constexpr std::size_t batch = 64;
+  std::size_t per_thread = total / threads_count;
+  std::vector<bench_node> nodes = make_nodes<bench_node>(
+      batch * threads_count);
+  std::string name = "sharded/insert + erase (" + std::string{list_name} +
+                     ", " + std::to_string(threads_count) + " threads)";
+  run_benchmark(name, per_thread * threads_count, [&] {
+    List list;
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_count; ++t) {
+      threads.emplace_back([&, t] {
+        std::span<bench_node> own{nodes.data() + t * batch, batch};
+        std::array<std::size_t, batch> shards;
+        for (std::size_t done = 0; done < per_thread; done += batch) {
+          for (std::size_t i = 0; i < batch; ++i) {
+            shards[i] = list.push(own[i]);
+          }
+          for (std::size_t i = 0; i < batch; ++i) {
+            list.erase(own[i], shards[i]);
+          }
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  });
+}
+
+void bench_sharded() {
+  for (std::size_t threads_count : {1, 2, 4, 8, 16, 32, 64}) {
+    bench_shared_list<locked_list>("mutex + list", threads_count);
+    bench_shared_list<sharded_bench_list>("sharded_list<16>",
+                                          threads_count);
+  }
+}
+
+struct rcu_bench_node : intrusive::rcu_list_element<> {
+  explicit rcu_bench_node(std::size_t value) : value(value) {}
+
+  std::size_t value;
+};
+
+/// The baseline for `rcu_list`: a list whose readers take a shared lock
+struct shared_locked_list {
+  std::size_t sum() {
+    std::shared_lock lock{mutex};
+    std::size_t result = 0;
+    for (const bench_node& n : list) {
+      result += n.value;
+    }
+    return result;
+  }
+
+  std::shared_mutex mutex;
+  intrusive::list<bench_node> list;
+};
+
+struct rcu_bench_list {
+  std::size_t sum() {
+    auto guard = list.read_lock();
+    std::size_t result = 0;
+    for (const rcu_bench_node& n : list) {
+      result += n.value;
+    }
+    return result;
+  }
+
+  intrusive::rcu_list<rcu_bench_node> list;
+};
+
+/// Threads summing a short read-mostly list, reports the time of a walk
+template <typename List, typename Node>
+void bench_read_mostly(std::string_view list_name,
+                       std::size_t threads_count) {
+  constexpr std::size_t length = 32;
+  constexpr std::size_t total = 1 << 18;
+  std::size_t per_thread = total / threads_count;
+  std::vector<Node> nodes = make_nodes<Node>(length);
+  List shared;
+  for (Node& n : nodes) {
+    shared.list.push_back(n);
+  }
+  std::string name = "rcu/read walk (" + std::string{list_name} + ", " +
+                     std::to_string(threads_count) + " threads)";
+  run_benchmark(name, per_thread * threads_count, [&] {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_count; ++t) {
+      threads.emplace_back([&] {
+        for (std::size_t i = 0; i < per_thread; ++i) {
+          do_not_optimize(shared.sum());
+        }
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  });
+}
+
+void bench_rcu() {
+  for (std::size_t threads_count : {1, 2, 4, 8}) {
+    bench_read_mostly<shared_locked_list, bench_node>("shared_mutex + list",
+                                                      threads_count);
+    bench_read_mostly<rcu_bench_list, rcu_bench_node>("rcu_list",
+                                                      threads_count);
+  }
+}
+
+struct epoch_bench_node : intrusive::list_element<intrusive::retire_tag> {
+  std::size_t value{0};
+};
+
+/// Returns disposed nodes to the free list of the thread that retired them
+struct free_list_disposer {
+  void operator()(epoch_bench_node& n) const {
+    free_nodes->push_back(&n);
+  }
+
+  std::vector<epoch_bench_node*>* free_nodes;
+};
+
+using bench_epoch_handle =
+    intrusive::epoch_handle<epoch_bench_node, free_list_disposer>;
+
+/// Threads cycling nodes of their own pools through retirement, reports
+/// the time a node takes from `retire` to its disposal
+void bench_retire(std::size_t threads_count) {
+  constexpr std::size_t total = 1 << 20;
+  constexpr std::size_t pool_size = 1024;
+  std::size_t per_thread = total / threads_count;
+  intrusive::epoch_domain domain;
+  std::string name = "epoch/retire + reclaim (" +
+                     std::to_string(threads_count) + " threads)";
+  run_benchmark(name, per_thread * threads_count, [&] {
+    std::vector<std::thread> threads;
+    for (std::size_t t = 0; t < threads_count; ++t) {
+      threads.emplace_back([&] {
+        std::vector<epoch_bench_node> pool(pool_size);
+        std::vector<epoch_bench_node*> free_nodes;
+        for (auto& n : pool) {
+          free_nodes.push_back(&n);
+        }
+        bench_epoch_handle handle{domain, free_list_disposer{&free_nodes}};
+        for (std::size_t i = 0; i < per_thread; ++i) {
+          while (free_nodes.empty()) {
+            handle.reclaim();
+            std::this_thread::yield();
+          }
+          epoch_bench_node* n = free_nodes.back();
+          free_nodes.pop_back();
+          {
+            auto guard = handle.pin();
+            do_not_optimize(++n->value);
+          }
+          handle.retire(*n);
+        }
+        handle.reclaim_all();
+      });
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  });
+}
+
+void bench_pin() {
+  constexpr std::size_t count = 1 << 20;
+  intrusive::epoch_domain domain;
+  std::vector<epoch_bench_node*> free_nodes;
+  bench_epoch_handle handle{domain, free_list_disposer{&free_nodes}};
+  run_benchmark("epoch/pin + unpin", count, [&] {
+    for (std::size_t i = 0; i < count; ++i) {
+      auto guard = handle.pin();
+      do_not_optimize(i);
+    }
+  });
+}
+
+void bench_epoch() {
+  bench_pin();
+  for (std::size_t threads_count : {1, 2, 4, 8}) {
+    bench_retire(threads_count);
+  }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  if (argc > 1) {
+    benchmark_filter = argv[1];
+  }
+  bench_push_erase();
+  bench_clear();
+  bench_offset_list();
+  bench_sort();
+  bench_dispose();
+  bench_insert_range();
+  bench_buckets();
+  bench_xor_list();
+  bench_index_list();
+  bench_relayout();
+  bench_prefetch();
+  bench_interleaved();
+  bench_erase_batch();
+  bench_queue();
+  bench_stack();
+  bench_sharded();
+  bench_rcu();
+  bench_epoch();
+}
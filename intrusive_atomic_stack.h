@@ -0,0 +1,174 @@
+#pragma once
+
+#include "intrusive_list.h"
+#include "intrusive_platform.h"
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+
+namespace intrusive {
+
+/// Lock-free LIFO stack (Treiber stack) over the same hooks as `list`,
+/// linked through the hook's `next` pointer, which is accessed atomically
+/// while the element is on the stack. The top pointer is packed into one
+/// 64-bit word with a generation counter (16 bits next to a 48-bit pointer
+/// on 64-bit targets) that every successful update increments, so a `pop`
+/// that read a stale top fails its CAS instead of corrupting the stack
+/// (ABA). An element whose address doesn't fit in those 48 bits (5-level
+/// paging, tagged pointers) can't be stacked: `push` aborts, in release
+/// builds too, rather than lose the high bits. As with any Treiber stack,
+/// a `pop` may read the link of an element that another thread has just
+/// popped: elements must stay in readable memory while the stack is used,
+/// which object pools provide. An element has to be popped before being
+/// destroyed or linked elsewhere
+template <typename T, typename Tag = default_tag>
+struct atomic_stack {
+  using value_traits = detail::hook_traits<T, Tag>;
+  using hook_type = typename value_traits::hook_type;
+
+  static constexpr link_mode mode = hook_type::mode;
+
+  static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                "atomic_stack needs a lock-free 64-bit CAS");
+  static_assert(sizeof(void*) <= sizeof(std::uint64_t),
+                "atomic_stack packs pointers into 64-bit words");
+
+  atomic_stack() = default;
+
+  atomic_stack(const atomic_stack&) = delete;
+  atomic_stack& operator=(const atomic_stack&) = delete;
+
+  /// `val` must not be contained in any list
+  void push(T& val) noexcept {
+    detail::list_base* node = value_traits::to_hook(&val);
+    // every pointer packed into `head` has been pushed, so checking here
+    // covers them all
+    if (!fits(node)) [[unlikely]] {
+      std::abort();
+    }
+    assert(mode == link_mode::normal || access::is_single(*node));
+    if constexpr (mode != link_mode::normal) {
+      // a null `prev` makes misuse of a stacked element fault loudly
+      access::prev(*node) = nullptr;
+    }
+    std::uint64_t old = head.load(std::memory_order_relaxed);
+    do {
+      store_link(node, pointer(old));
+    } while (!head.compare_exchange_weak(old, pack(node, generation(old) + 1),
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed));
+  }
+
+  /// Removes the most recently pushed element, nullptr if there's none
+  T* pop() noexcept {
+    std::uint64_t old = head.load(std::memory_order_acquire);
+    while (pointer(old) != nullptr) {
+      detail::list_base* top = pointer(old);
+      detail::list_base* next = load_link(top);
+      if (head.compare_exchange_weak(old, pack(next, generation(old) + 1),
+                                     std::memory_order_acquire,
+                                     std::memory_order_acquire)) {
+        release(top);
+        return value_traits::to_value(top);
+      }
+    }
+    return nullptr;
+  }
+
+  /// Atomically takes all elements off the stack, the returned list holds
+  /// them from the most recently pushed one
+  template <typename SizePolicy = linear_time_size>
+  list<T, Tag, SizePolicy> pop_all() noexcept {
+    std::uint64_t old = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(old, pack(nullptr, generation(old) + 1),
+                                       std::memory_order_acquire,
+                                       std::memory_order_relaxed)) {
+    }
+    list<T, Tag, SizePolicy> result;
+    for (detail::list_base* node = pointer(old); node != nullptr;) {
+      detail::list_base* next = load_link(node);
+      release(node);
+      result.push_back(*value_traits::to_value(node));
+      node = next;
+    }
+    return result;
+  }
+
+  /// Returns true if the stack was empty at some point during the call
+  bool empty() const noexcept {
+    return pointer(head.load(std::memory_order_acquire)) == nullptr;
+  }
+
+  ~atomic_stack() {
+    assert(empty());
+  }
+
+private:
+  using access = detail::list_access;
+
+  static constexpr unsigned pointer_bits = sizeof(void*) == 8 ? 48 : 32;
+  static constexpr std::uint64_t pointer_mask =
+      (std::uint64_t{1} << pointer_bits) - 1;
+
+  static std::uint64_t address(const detail::list_base* node) noexcept {
+    return static_cast<std::uint64_t>(
+        reinterpret_cast<std::uintptr_t>(node));
+  }
+
+  static bool fits(const detail::list_base* node) noexcept {
+    return (address(node) & ~pointer_mask) == 0;
+  }
+
+  static std::uint64_t pack(detail::list_base* node,
+                            std::uint64_t generation) noexcept {
+    assert(fits(node));
+    return address(node) | (generation << pointer_bits);
+  }
+
+  static detail::list_base* pointer(std::uint64_t word) noexcept {
+    return reinterpret_cast<detail::list_base*>(
+        static_cast<std::uintptr_t>(word & pointer_mask));
+  }
+
+  static std::uint64_t generation(std::uint64_t word) noexcept {
+    return word >> pointer_bits;
+  }
+
+  // NOTE: the links are plain pointers shared with `list`, accessed through
+  // `std::atomic_ref` where the library has it (libc++ only since 19), else
+  // through the compiler builtins it's implemented with
+  static detail::list_base* load_link(detail::list_base* node) noexcept {
+#if defined(__cpp_lib_atomic_ref)
+    return std::atomic_ref<detail::list_base*>{access::next(*node)}.load(
+        std::memory_order_relaxed);
+#else
+    return __atomic_load_n(&access::next(*node), __ATOMIC_RELAXED);
+#endif
+  }
+
+  static void store_link(detail::list_base* node,
+                         detail::list_base* value) noexcept {
+#if defined(__cpp_lib_atomic_ref)
+    std::atomic_ref<detail::list_base*>{access::next(*node)}.store(
+        value, std::memory_order_relaxed);
+#else
+    __atomic_store_n(&access::next(*node), value, __ATOMIC_RELAXED);
+#endif
+  }
+
+  /// Brings a node taken off the stack to the state its link mode expects
+  /// of an unlinked element. The link is written atomically: a concurrent
+  /// `pop` may still be reading it
+  static void release(detail::list_base* node) noexcept {
+    if constexpr (mode != link_mode::normal) {
+      store_link(node, node);
+      access::prev(*node) = node;
+    }
+  }
+
+  alignas(detail::cache_line_size) std::atomic<std::uint64_t> head{0};
+};
+
+} // namespace intrusive
@@ -0,0 +1,237 @@
+#pragma once
+
+#include "intrusive_list.h"
+#include "intrusive_platform.h"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace intrusive {
+
+/// Default hook tag of the retire lists of `epoch_handle`
+struct retire_tag;
+
+struct epoch_domain;
+
+template <typename T, typename Disposer, typename Tag>
+struct epoch_handle;
+
+namespace detail {
+
+struct epoch_registry_tag;
+
+/// Per-thread state of an `epoch_domain`: the epoch the thread is pinned
+/// in. Registered records are linked in the domain's registry
+struct epoch_record : list_element<epoch_registry_tag> {
+  /// `state` holds the epoch shifted left by one and this bit
+  static constexpr std::uint64_t pinned_bit = 1;
+
+  explicit epoch_record(epoch_domain& domain_) noexcept : domain{&domain_} {}
+
+  epoch_record(const epoch_record&) = delete;
+  epoch_record& operator=(const epoch_record&) = delete;
+
+  epoch_domain* domain;
+  // read by threads advancing the epoch, written only by the owner
+  alignas(cache_line_size) std::atomic<std::uint64_t> state{0};
+  std::size_t nesting{0};
+};
+
+} // namespace detail
+
+/// Epoch-based reclamation: defers disposing of unlinked nodes until no
+/// thread can still hold a pointer to them. Threads access shared nodes
+/// only while pinned (`epoch_handle::pin`). A node retired in epoch `e`
+/// is disposed of once the global epoch has reached `e + 2`, and the
+/// epoch only advances when every pinned thread has observed the current
+/// one. A thread that stays pinned therefore holds back reclamation for
+/// all threads of the domain
+struct epoch_domain {
+  epoch_domain() = default;
+
+  epoch_domain(const epoch_domain&) = delete;
+  epoch_domain& operator=(const epoch_domain&) = delete;
+
+  std::uint64_t current_epoch() const noexcept {
+    return global.load(std::memory_order_acquire);
+  }
+
+  /// Advances the global epoch if every pinned thread is in the current
+  /// one. Never blocks: gives up if another thread is scanning
+  bool try_advance() noexcept {
+    std::unique_lock lock{registry_lock, std::try_to_lock};
+    if (!lock.owns_lock()) {
+      return false;
+    }
+    std::uint64_t epoch = global.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // acquiring the states orders disposals after the reads threads made
+    // before unpinning
+    for (const detail::epoch_record& record : records) {
+      std::uint64_t state = record.state.load(std::memory_order_acquire);
+      if ((state & detail::epoch_record::pinned_bit) != 0 &&
+          (state >> 1) != epoch) {
+        return false;
+      }
+    }
+    return global.compare_exchange_strong(epoch, epoch + 1,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed);
+  }
+
+  ~epoch_domain() {
+    assert(records.empty());
+  }
+
+private:
+  void enroll(detail::epoch_record& record) noexcept {
+    std::lock_guard lock{registry_lock};
+    records.push_back(record);
+  }
+
+  void withdraw(detail::epoch_record& record) noexcept {
+    std::lock_guard lock{registry_lock};
+    records.erase(records.iterator_to(record));
+  }
+
+  template <typename T, typename Disposer, typename Tag>
+  friend struct epoch_handle;
+
+  alignas(detail::cache_line_size) std::atomic<std::uint64_t> global{0};
+  alignas(detail::cache_line_size) std::mutex registry_lock;
+  list<detail::epoch_record, detail::epoch_registry_tag> records;
+};
+
+/// Keeps the thread pinned in an epoch, guards nest
+struct epoch_guard {
+  explicit epoch_guard(detail::epoch_record& record_) noexcept
+      : record{&record_} {
+    if (record->nesting++ == 0) {
+      std::uint64_t epoch = record->domain->current_epoch();
+      record->state.store((epoch << 1) | detail::epoch_record::pinned_bit,
+                          std::memory_order_relaxed);
+      // the pin must be visible before any shared node is read
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+  }
+
+  epoch_guard(const epoch_guard&) = delete;
+  epoch_guard& operator=(const epoch_guard&) = delete;
+
+  ~epoch_guard() {
+    if (--record->nesting == 0) {
+      record->state.store(record->state.load(std::memory_order_relaxed) &
+                              ~detail::epoch_record::pinned_bit,
+                          std::memory_order_release);
+    }
+  }
+
+private:
+  detail::epoch_record* record;
+};
+
+/// A thread's membership in an `epoch_domain`, owned and used by that
+/// thread only. Retired nodes are parked in three intrusive lists over the
+/// `list_element<Tag>` hook, one per epoch modulo 3, so a whole bucket is
+/// disposed of at once when its epoch is old enough. This hook must not be
+/// the one concurrent readers follow: they may still be walking a retired
+/// node's links. After `threshold` retired nodes the handle tries to
+/// advance the epoch and reclaim, so while no thread stays pinned it holds
+/// at most about 3 * `threshold` nodes
+template <typename T, typename Disposer, typename Tag = retire_tag>
+struct epoch_handle {
+  using retire_list = list<T, Tag, constant_time_size>;
+
+  static constexpr std::size_t default_threshold = 64;
+
+  epoch_handle(epoch_domain& domain, Disposer dispose_ = {},
+               std::size_t threshold_ = default_threshold) noexcept
+      : record{domain}, dispose{std::move(dispose_)},
+        threshold{threshold_} {
+    domain.enroll(record);
+  }
+
+  epoch_handle(const epoch_handle&) = delete;
+  epoch_handle& operator=(const epoch_handle&) = delete;
+
+  /// Pins the thread: nodes reachable while the guard is alive aren't
+  /// disposed of
+  [[nodiscard]] epoch_guard pin() noexcept {
+    return epoch_guard{record};
+  }
+
+  bool is_pinned() const noexcept {
+    return record.nesting != 0;
+  }
+
+  /// Hands over `val`, already unlinked from every shared structure, to
+  /// be disposed of once no thread can hold a pointer to it
+  void retire(T& val) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    std::uint64_t epoch = domain().current_epoch();
+    collect(epoch);
+    buckets[epoch % 3].push_back(val);
+    bucket_epochs[epoch % 3] = epoch;
+    if (retired_count() >= threshold) {
+      reclaim();
+    }
+  }
+
+  /// Tries to advance the epoch, then disposes of every bucket old enough
+  void reclaim() {
+    domain().try_advance();
+    collect(domain().current_epoch());
+  }
+
+  /// Waits until every retired node has been disposed of. The calling
+  /// thread must not be pinned, other threads have to unpin eventually
+  void reclaim_all() {
+    assert(!is_pinned());
+    while (retired_count() != 0) {
+      reclaim();
+      if (retired_count() != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  /// Number of retired nodes not disposed of yet
+  std::size_t retired_count() const noexcept {
+    return buckets[0].size() + buckets[1].size() + buckets[2].size();
+  }
+
+  /// Leaves the domain, waiting for the retired nodes to be disposed of
+  ~epoch_handle() {
+    assert(!is_pinned());
+    domain().withdraw(record);
+    reclaim_all();
+  }
+
+private:
+  epoch_domain& domain() noexcept {
+    return *record.domain;
+  }
+
+  void collect(std::uint64_t epoch) {
+    for (std::size_t i = 0; i < 3; ++i) {
+      if (!buckets[i].empty() && bucket_epochs[i] + 2 <= epoch) {
+        buckets[i].clear_and_dispose(std::ref(dispose));
+      }
+    }
+  }
+
+  detail::epoch_record record;
+  Disposer dispose;
+  std::size_t threshold;
+  std::array<retire_list, 3> buckets;
+  std::array<std::uint64_t, 3> bucket_epochs{};
+};
+
+} // namespace intrusive
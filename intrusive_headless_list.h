@@ -0,0 +1,255 @@
+#pragma once
+
+#include "intrusive_list.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace intrusive {
+
+/// Circular doubly linked list without a sentinel: the list itself is a
+/// single pointer to the first element, `nullptr` when empty. Uses the same
+/// hooks as `list`, but only in `link_mode::normal`: a sole element links
+/// to itself, which is also how an unlinked hook looks, so the checks of
+/// the other modes couldn't tell whether it's contained. Since elements
+/// don't know the head, an element has to be erased through its list
+/// before being destroyed or inserted elsewhere
+template <typename T, typename Tag = default_tag>
+struct headless_list {
+  using value_traits = detail::hook_traits<T, Tag>;
+  using hook_type = typename value_traits::hook_type;
+
+  static constexpr link_mode mode = hook_type::mode;
+  static_assert(mode == link_mode::normal,
+                "headless_list needs a link_mode::normal hook");
+
+  headless_list() = default;
+
+  headless_list(headless_list&& other) noexcept
+      : head{std::exchange(other.head, nullptr)} {}
+
+  headless_list& operator=(headless_list&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    head = std::exchange(other.head, nullptr);
+    return *this;
+  }
+
+  template <bool Const>
+  struct generic_iterator;
+
+  using iterator = generic_iterator<false>;
+  using const_iterator = generic_iterator<true>;
+
+  template <bool Const>
+  struct generic_iterator {
+    using value_type = std::conditional_t<Const, const T, T>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    generic_iterator() = default;
+    generic_iterator(const generic_iterator& iter) = default;
+
+    template <bool Dummy = Const, typename = std::enable_if_t<Dummy>>
+    generic_iterator(const iterator& iter)
+        : data{iter.data}, owner{iter.owner} {}
+
+    pointer operator->() const {
+      return value_traits::to_value(data);
+    }
+
+    reference operator*() const {
+      return *value_traits::to_value(data);
+    }
+
+    generic_iterator& operator++() {
+      data = access::next(*data);
+      if (data == owner->head) {
+        data = nullptr;
+      }
+      return *this;
+    }
+
+    generic_iterator operator++(int) {
+      generic_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    generic_iterator& operator--() {
+      data = access::prev(data == nullptr ? *owner->head : *data);
+      return *this;
+    }
+
+    generic_iterator operator--(int) {
+      generic_iterator result = *this;
+      --*this;
+      return result;
+    }
+
+    template <bool ConstRhs>
+    bool operator==(const generic_iterator<ConstRhs>& rhs) const {
+      return data == rhs.data;
+    }
+
+    template <bool ConstRhs>
+    bool operator!=(const generic_iterator<ConstRhs>& rhs) const {
+      return data != rhs.data;
+    }
+
+  private:
+    generic_iterator(detail::list_base* data_, const headless_list* owner_)
+        : data{data_}, owner{owner_} {};
+    friend headless_list;
+
+    // nullptr for the end iterator
+    detail::list_base* data{nullptr};
+    const headless_list* owner{nullptr};
+  };
+
+  void push_back(T& val) noexcept {
+    insert(end(), val);
+  }
+
+  void push_front(T& val) noexcept {
+    insert(begin(), val);
+  }
+
+  void clear() noexcept {
+    head = nullptr;
+  }
+
+  void pop_back() noexcept {
+    erase(std::prev(end()));
+  }
+
+  void pop_front() noexcept {
+    erase(begin());
+  }
+
+  const T& back() const noexcept {
+    return *std::prev(end());
+  }
+
+  T& back() noexcept {
+    return *std::prev(end());
+  }
+
+  const T& front() const noexcept {
+    return *begin();
+  }
+
+  T& front() noexcept {
+    return *begin();
+  }
+
+  bool empty() const noexcept {
+    return head == nullptr;
+  }
+
+  iterator begin() noexcept {
+    return iterator{head, this};
+  }
+
+  const_iterator begin() const noexcept {
+    return const_iterator{head, this};
+  }
+
+  iterator end() noexcept {
+    return iterator{nullptr, this};
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator{nullptr, this};
+  }
+
+  /// Iterator to `val`, which must be contained in this list. O(1)
+  iterator iterator_to(T& val) noexcept {
+    return iterator{value_traits::to_hook(&val), this};
+  }
+
+  const_iterator iterator_to(const T& val) const noexcept {
+    return const_iterator{value_traits::to_hook(const_cast<T*>(&val)), this};
+  }
+
+  /// `val` must not be contained in any list
+  iterator insert(const_iterator pos, T& val) noexcept {
+    detail::list_base* node = value_traits::to_hook(&val);
+    if (head == nullptr) {
+      access::prev(*node) = access::next(*node) = node;
+      head = node;
+    } else {
+      link_before(pos.data == nullptr ? head : pos.data, node, node);
+      if (pos.data == head) {
+        head = node;
+      }
+    }
+    return iterator{node, this};
+  }
+
+  iterator erase(iterator it) noexcept {
+    assert(!empty());
+    detail::list_base* node = it.data;
+    detail::list_base* next = access::next(*node);
+    if (next == node) {
+      head = nullptr;
+      next = nullptr;
+    } else {
+      bool was_last = next == head;
+      access::next(*access::prev(*node)) = next;
+      access::prev(*next) = access::prev(*node);
+      if (node == head) {
+        head = next;
+      }
+      if (was_last) {
+        next = nullptr;
+      }
+    }
+    return iterator{next, this};
+  }
+
+  /// Moves all elements of `other` before `pos` in O(1)
+  void splice(const_iterator pos, headless_list& other) noexcept {
+    if (other.empty() || this == &other) {
+      return;
+    }
+    detail::list_base* first = std::exchange(other.head, nullptr);
+    if (head == nullptr) {
+      head = first;
+      return;
+    }
+    link_before(pos.data == nullptr ? head : pos.data, first,
+                access::prev(*first));
+    if (pos.data == head) {
+      head = first;
+    }
+  }
+
+  ~headless_list() {
+    clear();
+  }
+
+private:
+  using access = detail::list_access;
+
+  /// Links the chain [first, last] before `pos`
+  static void link_before(detail::list_base* pos, detail::list_base* first,
+                          detail::list_base* last) noexcept {
+    detail::list_base* before = access::prev(*pos);
+    access::next(*before) = first;
+    access::prev(*first) = before;
+    access::next(*last) = pos;
+    access::prev(*pos) = last;
+  }
+
+  detail::list_base* head{nullptr};
+};
+
+} // namespace intrusive
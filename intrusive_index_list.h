@@ -0,0 +1,327 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace intrusive {
+
+/// Doubly linked list over the slots of a contiguous array of T, e.g. the
+/// buffer of a `std::vector<T>`. Links aren't stored in the elements: they
+/// are 32-bit slot indices kept in two arrays parallel to the storage, so T
+/// needs no hook, walking the list touches only dense link arrays and the
+/// elements visited, and the storage may be relocated (`realloc`, vector
+/// growth) as long as the list is `rebind`-ed to the new location. The
+/// list doesn't own the storage, only its own link arrays
+template <typename T>
+struct index_list {
+  using size_type = std::size_t;
+
+  /// Link value referring to the head of the list
+  static constexpr std::uint32_t head_index = UINT32_MAX;
+  /// NOTE: marker for slots not in the list: prev == next == unlinked_index
+  static constexpr std::uint32_t unlinked_index = UINT32_MAX - 1;
+
+  index_list() = default;
+
+  /// All slots of `storage` start unlinked
+  explicit index_list(std::span<T> storage) {
+    rebind(storage);
+  }
+
+  index_list(index_list&& other) noexcept
+      : data{std::exchange(other.data, {})},
+        prev_links{std::move(other.prev_links)},
+        next_links{std::move(other.next_links)},
+        first{std::exchange(other.first, head_index)},
+        last{std::exchange(other.last, head_index)},
+        count{std::exchange(other.count, 0)} {
+    other.prev_links.clear();
+    other.next_links.clear();
+  }
+
+  index_list& operator=(index_list&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    data = std::exchange(other.data, {});
+    prev_links = std::move(other.prev_links);
+    next_links = std::move(other.next_links);
+    other.prev_links.clear();
+    other.next_links.clear();
+    first = std::exchange(other.first, head_index);
+    last = std::exchange(other.last, head_index);
+    count = std::exchange(other.count, 0);
+    return *this;
+  }
+
+  template <bool Const>
+  struct generic_iterator;
+
+  using iterator = generic_iterator<false>;
+  using const_iterator = generic_iterator<true>;
+
+  template <bool Const>
+  struct generic_iterator {
+    using value_type = std::conditional_t<Const, const T, T>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    generic_iterator() = default;
+    generic_iterator(const generic_iterator& iter) = default;
+
+    template <bool Dummy = Const, typename = std::enable_if_t<Dummy>>
+    generic_iterator(const iterator& iter)
+        : owner{iter.owner}, index{iter.index} {}
+
+    pointer operator->() const {
+      return &owner->data[index];
+    }
+
+    reference operator*() const {
+      return owner->data[index];
+    }
+
+    generic_iterator& operator++() {
+      index = owner->next_of(index);
+      return *this;
+    }
+
+    generic_iterator operator++(int) {
+      generic_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    generic_iterator& operator--() {
+      index = owner->prev_of(index);
+      return *this;
+    }
+
+    generic_iterator operator--(int) {
+      generic_iterator result = *this;
+      --*this;
+      return result;
+    }
+
+    template <bool ConstRhs>
+    bool operator==(const generic_iterator<ConstRhs>& rhs) const {
+      return index == rhs.index;
+    }
+
+    template <bool ConstRhs>
+    bool operator!=(const generic_iterator<ConstRhs>& rhs) const {
+      return index != rhs.index;
+    }
+
+    /// Slot of the element in the storage
+    std::uint32_t slot() const noexcept {
+      return index;
+    }
+
+  private:
+    generic_iterator(const index_list* owner_, std::uint32_t index_)
+        : owner{owner_}, index{index_} {};
+    friend index_list;
+
+    const index_list* owner{nullptr};
+    std::uint32_t index{head_index};
+  };
+
+  /// Points the list to `storage`, which holds the same elements at the
+  /// same slots as the previous storage, followed by new unlinked slots.
+  /// Slots dropped by shrinking must be unlinked
+  void rebind(std::span<T> storage) {
+    assert(storage.size() < unlinked_index);
+    for (std::size_t slot = storage.size(); slot < next_links.size();
+         ++slot) {
+      assert(next_links[slot] == unlinked_index);
+    }
+    data = storage.data();
+    prev_links.resize(storage.size(), unlinked_index);
+    next_links.resize(storage.size(), unlinked_index);
+  }
+
+  /// Number of slots of the storage
+  size_type capacity() const noexcept {
+    return next_links.size();
+  }
+
+  void push_back(T& val) noexcept {
+    insert(end(), val);
+  }
+
+  void push_front(T& val) noexcept {
+    insert(begin(), val);
+  }
+
+  void clear() noexcept {
+    for (std::uint32_t slot = first; slot != head_index;) {
+      std::uint32_t next = next_links[slot];
+      prev_links[slot] = next_links[slot] = unlinked_index;
+      slot = next;
+    }
+    first = last = head_index;
+    count = 0;
+  }
+
+  void pop_back() noexcept {
+    erase(std::prev(end()));
+  }
+
+  void pop_front() noexcept {
+    erase(begin());
+  }
+
+  const T& back() const noexcept {
+    return *std::prev(end());
+  }
+
+  T& back() noexcept {
+    return *std::prev(end());
+  }
+
+  const T& front() const noexcept {
+    return *begin();
+  }
+
+  T& front() noexcept {
+    return *begin();
+  }
+
+  bool empty() const noexcept {
+    return first == head_index;
+  }
+
+  /// O(1), the list keeps count of its elements
+  size_type size() const noexcept {
+    return count;
+  }
+
+  iterator begin() noexcept {
+    return iterator{this, first};
+  }
+
+  const_iterator begin() const noexcept {
+    return const_iterator{this, first};
+  }
+
+  iterator end() noexcept {
+    return iterator{this, head_index};
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator{this, head_index};
+  }
+
+  /// Slot of `val`, which must lie in the storage
+  std::uint32_t slot_of(const T& val) const noexcept {
+    assert(&val >= data && &val < data + capacity());
+    return static_cast<std::uint32_t>(&val - data);
+  }
+
+  bool is_linked(std::uint32_t slot) const noexcept {
+    return next_links[slot] != unlinked_index;
+  }
+
+  /// Iterator to `val`, which must be contained in this list. O(1)
+  iterator iterator_to(T& val) noexcept {
+    return iterator{this, slot_of(val)};
+  }
+
+  const_iterator iterator_to(const T& val) const noexcept {
+    return const_iterator{this, slot_of(val)};
+  }
+
+  /// `val` must lie in the storage and must not be contained in the list
+  iterator insert(const_iterator pos, T& val) noexcept {
+    std::uint32_t slot = slot_of(val);
+    assert(!is_linked(slot));
+    std::uint32_t prev = prev_of(pos.index);
+    prev_links[slot] = prev;
+    next_links[slot] = pos.index;
+    next_link(prev) = slot;
+    prev_link(pos.index) = slot;
+    ++count;
+    return iterator{this, slot};
+  }
+
+  iterator erase(const_iterator pos) noexcept {
+    assert(!empty());
+    std::uint32_t slot = pos.index;
+    std::uint32_t next = next_links[slot];
+    next_link(prev_links[slot]) = next;
+    prev_link(next) = prev_links[slot];
+    prev_links[slot] = next_links[slot] = unlinked_index;
+    --count;
+    return iterator{this, next};
+  }
+
+  /// Number of linked slots, a single pass over the `next` links the
+  /// compiler can vectorize. O(capacity), unlike `size`, but it recounts
+  /// from the links themselves
+  size_type count_linked() const noexcept {
+    size_type result = 0;
+    for (std::uint32_t link : next_links) {
+      result += link != unlinked_index;
+    }
+    return result;
+  }
+
+  /// First unlinked slot not before `from`, `capacity()` if there's none.
+  /// Blocks of links are tested without branches, only a block containing
+  /// a free slot is searched element by element
+  size_type find_unlinked(size_type from = 0) const noexcept {
+    constexpr size_type block = 16;
+    const std::uint32_t* links = next_links.data();
+    size_type slot = from;
+    for (; slot + block <= capacity(); slot += block) {
+      bool any = false;
+      for (size_type i = 0; i < block; ++i) {
+        any |= links[slot + i] == unlinked_index;
+      }
+      if (any) {
+        break;
+      }
+    }
+    for (; slot < capacity(); ++slot) {
+      if (links[slot] == unlinked_index) {
+        return slot;
+      }
+    }
+    return capacity();
+  }
+
+private:
+  std::uint32_t next_of(std::uint32_t slot) const noexcept {
+    return slot == head_index ? first : next_links[slot];
+  }
+
+  std::uint32_t prev_of(std::uint32_t slot) const noexcept {
+    return slot == head_index ? last : prev_links[slot];
+  }
+
+  std::uint32_t& next_link(std::uint32_t slot) noexcept {
+    return slot == head_index ? first : next_links[slot];
+  }
+
+  std::uint32_t& prev_link(std::uint32_t slot) noexcept {
+    return slot == head_index ? last : prev_links[slot];
+  }
+
+  T* data{nullptr};
+  std::vector<std::uint32_t> prev_links;
+  std::vector<std::uint32_t> next_links;
+  std::uint32_t first{head_index};
+  std::uint32_t last{head_index};
+  size_type count{0};
+};
+
+} // namespace intrusive
@@ -1,61 +1,453 @@
 #pragma once
 
+#include "intrusive_platform.h"
+
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
 #include <iterator>
+#include <span>
 #include <type_traits>
 #include <utility>
 
 namespace intrusive {
 struct default_tag;
 
-template <typename T, typename Tag>
+/// Size policies of `list`: with `linear_time_size` the list stores nothing
+/// and `size()` walks the chain, with `constant_time_size` every modifier
+/// keeps a counter up to date. The latter requires elements to be erased
+/// through the list, not by their own destructors or by inserting them into
+/// another list
+struct linear_time_size;
+struct constant_time_size;
+
+/// What a hook does on erase and destruction:
+/// - `safe`: erased elements are reset and a destroyed element unlinks itself
+/// - `checked`: erased elements are reset and destroying a linked element
+///   is an assertion failure
+/// - `normal`: hooks are never reset, so `erase` writes only to neighbours
+///   and `clear` is O(1). An element must not be destroyed or inserted into
+///   another list while it's linked, and moving it doesn't transplant it
+enum class link_mode { safe, checked, normal };
+
+template <typename T, typename Tag, typename SizePolicy>
 struct list;
 
+template <typename Tag, link_mode Mode>
+struct list_element;
+
+template <typename Tag, link_mode Mode>
+struct list_head_element;
+
+/// Passed to `list` instead of a tag to use a `list_element` data member of
+/// T as the hook, e.g. `list<T, member_hook<&T::lru_hook>>`. The member may
+/// belong to T or to a non-virtual base of T, and T may be abstract
+template <auto Member>
+struct member_hook;
+
 namespace detail {
 
 struct list_base {
   // NOTE: marker for non-connected/sentinel node: prev == next == this
-  list_base();
-  list_base(list_base&& other);
-  list_base(const list_base&);
-  list_base& operator=(list_base&& other);
+  constexpr list_base() noexcept : prev{this}, next{this} {}
+
+  constexpr list_base(list_base&& other) noexcept : list_base{} {
+    *this = std::move(other);
+  }
+
+  // not default!
+  constexpr list_base(const list_base&) noexcept : list_base{} {}
+
+  constexpr list_base& operator=(list_base&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    assert(is_single()); // otherwise it's illegal to do an assignment
+    if (other.is_single()) {
+      // noop
+      return *this;
+    }
+    prev = other.prev;
+    next = other.next;
+
+    prev->next = this;
+    next->prev = this;
+
+    other.prev = &other;
+    other.next = &other;
+    return *this;
+  }
+
   list_base& operator=(const list_base&) = delete;
-  ~list_base();
+
+  ~list_base() = default;
 
 private:
   /// Returns true if node is not contained in any list or is a sentinel
-  bool is_single() const;
-  /// Remove node from a list (has no effect if a node is single);
-  void unlink();
+  constexpr bool is_single() const noexcept {
+    return prev == this && next == this;
+  }
+
+  /// The link referring to this node: `prev->next`, or the head pointer if
+  /// the node is the first element of a `list_head`
+  constexpr list_base*& incoming_link() noexcept {
+    if (!std::is_constant_evaluated()) {
+      auto bits = reinterpret_cast<std::uintptr_t>(prev);
+      if (bits & head_link_bit) {
+        return *reinterpret_cast<list_base**>(bits - head_link_bit);
+      }
+    }
+    return prev->next;
+  }
+
+  /// Remove node from a list (has no effect if a node is single)
+  constexpr void unlink() noexcept {
+    // No need to check in case of single node
+    prev->next = next;
+    next->prev = prev;
+    prev = next = this;
+  }
+
+  /// Same as `unlink`, but the node may also be the first (tagged `prev`)
+  /// or the last (null `next`) element of a `list_head`
+  constexpr void unlink_any() noexcept {
+    incoming_link() = next;
+    if (next != nullptr) {
+      next->prev = prev;
+    }
+    prev = next = this;
+  }
+
+  /// Same as the move assignment, but `other` may also be contained in a
+  /// `list_head`
+  constexpr void take_place_of(list_base& other) noexcept {
+    if (this == &other) {
+      return;
+    }
+    assert(is_single()); // otherwise it's illegal to do an assignment
+    if (other.is_single()) {
+      return;
+    }
+    prev = other.prev;
+    next = other.next;
+
+    incoming_link() = this;
+    if (next != nullptr) {
+      next->prev = this;
+    }
+
+    other.prev = &other;
+    other.next = &other;
+  }
+
+  /// Make the neighbours bypass this node, leaving its own pointers stale.
+  /// Only for nodes contained in a `list`
+  constexpr void detach() noexcept {
+    prev->next = next;
+    next->prev = prev;
+  }
+
   /// Insert `other` before this element
-  void insert(list_base& other);
+  constexpr void insert(list_base& other) noexcept {
+    if (this == &other) {
+      // We don't want to insert the element before itself
+      return;
+    }
+    other.unlink();
+    assert(other.is_single());
+    link_before(other);
+  }
+
+  /// Insert `other` before this element, `other`'s pointers are ignored
+  constexpr void link_before(list_base& other) noexcept {
+    prev->next = &other;
+    other.prev = this->prev;
 
-  template <typename T, typename Tag>
+    other.next = this;
+    this->prev = &other;
+  }
+
+  template <typename T, typename Tag, typename SizePolicy>
   friend struct ::intrusive::list;
 
+  template <typename Tag, link_mode Mode>
+  friend struct ::intrusive::list_element;
+
+  template <typename Tag, link_mode Mode>
+  friend struct ::intrusive::list_head_element;
+
+  friend struct list_access;
+
+  /// Set in `prev` of the first element of a `list_head`, which then holds
+  /// the address of the head pointer instead of a node
+  static constexpr std::uintptr_t head_link_bit = 1;
+
   list_base* prev;
   list_base* next;
 };
 
+/// Raw link access for algorithms working on whole chains of nodes, which
+/// are responsible for leaving every list consistent
+struct list_access {
+  static list_base*& prev(list_base& node) noexcept {
+    return node.prev;
+  }
+
+  static list_base*& next(list_base& node) noexcept {
+    return node.next;
+  }
+
+  static bool is_single(const list_base& node) noexcept {
+    return node.is_single();
+  }
+
+  static void unlink(list_base& node) noexcept {
+    node.unlink();
+  }
+
+  static void unlink_any(list_base& node) noexcept {
+    node.unlink_any();
+  }
+
+  static list_base*& incoming_link(list_base& node) noexcept {
+    return node.incoming_link();
+  }
+
+  /// Value for `prev` of a node linked right after the head pointer `head`
+  static list_base* head_link(list_base** head) noexcept {
+    auto bits = reinterpret_cast<std::uintptr_t>(head);
+    return reinterpret_cast<list_base*>(bits | list_base::head_link_bit);
+  }
+};
+
+/// Element counter of a `constant_time_size` list
+struct size_counter {
+  std::size_t value{0};
+};
+
+/// Stand-in for the counter of a `linear_time_size` list, occupies no space
+struct no_size_counter {};
+
 } // namespace detail
 
-template <typename Tag = default_tag>
-struct list_element : public detail::list_base {};
+template <typename Tag = default_tag, link_mode Mode = link_mode::safe>
+struct list_element : public detail::list_base {
+  static constexpr link_mode mode = Mode;
+  /// Whether the hook copes with being linked in a `list_head`
+  static constexpr bool head_aware = false;
 
-template <typename T, typename Tag = default_tag>
-struct list {
-  static_assert(std::is_base_of_v<list_element<Tag>, T>,
+  constexpr list_element() noexcept = default;
+  constexpr list_element(const list_element&) noexcept = default;
+
+  constexpr list_element(list_element&& other) noexcept {
+    if constexpr (Mode != link_mode::normal) {
+      list_base::operator=(std::move(other));
+    }
+  }
+
+  constexpr list_element& operator=(list_element&& other) noexcept {
+    if constexpr (Mode != link_mode::normal) {
+      list_base::operator=(std::move(other));
+    }
+    return *this;
+  }
+
+  list_element& operator=(const list_element&) = delete;
+
+  constexpr ~list_element() {
+    if constexpr (Mode == link_mode::safe) {
+      unlink();
+    } else if constexpr (Mode == link_mode::checked) {
+      assert(is_single());
+    }
+  }
+};
+
+/// Hook for elements of a `list_head`, which may also be linked into a
+/// `list` with the same tag. Unlike a plain `list_element`, it unlinks
+/// itself and moves correctly when it's the first element of a `list_head`
+/// (whose `prev` is the tagged address of the head pointer) or the last one
+/// (whose `next` is null). Plain hooks don't pay for these checks
+template <typename Tag = default_tag, link_mode Mode = link_mode::safe>
+struct list_head_element : public list_element<Tag, Mode> {
+  static constexpr bool head_aware = true;
+
+  constexpr list_head_element() noexcept = default;
+  constexpr list_head_element(const list_head_element&) noexcept = default;
+
+  constexpr list_head_element(list_head_element&& other) noexcept
+      : list_element<Tag, Mode>{} {
+    if constexpr (Mode != link_mode::normal) {
+      this->take_place_of(other);
+    }
+  }
+
+  constexpr list_head_element& operator=(list_head_element&& other) noexcept {
+    if constexpr (Mode != link_mode::normal) {
+      this->take_place_of(other);
+    }
+    return *this;
+  }
+
+  list_head_element& operator=(const list_head_element&) = delete;
+
+  // the base destructor then finds the node single
+  constexpr ~list_head_element() {
+    if constexpr (Mode == link_mode::safe) {
+      this->unlink_any();
+    }
+  }
+};
+
+namespace detail {
+
+/// Finds the unique `list_element<Tag, Mode>` base of T, `void` if none.
+/// A `list_head_element` base is preferred to the `list_element` it
+/// derives from
+template <typename Tag>
+struct hook_of {
+  template <link_mode Mode>
+  static list_element<Tag, Mode> deduce(const list_element<Tag, Mode>*);
+  template <link_mode Mode>
+  static list_head_element<Tag, Mode>
+  deduce(const list_head_element<Tag, Mode>*);
+  static void deduce(...);
+};
+
+/// Conversions between an element and its hook for `list<T, Tag>`, this one
+/// is for hooks that are base classes
+template <typename T, typename Tag>
+struct hook_traits {
+  using hook_type =
+      decltype(hook_of<Tag>::deduce(static_cast<const T*>(nullptr)));
+
+  static_assert(!std::is_void_v<hook_type>,
                 "T should derive from list_element<Tag>");
 
+  static hook_type* to_hook(T* val) noexcept {
+    return static_cast<hook_type*>(val);
+  }
+
+  static T* to_value(list_base* node) noexcept {
+    return static_cast<T*>(static_cast<hook_type*>(node));
+  }
+};
+
+template <typename MemberPointer>
+struct member_pointer_traits;
+
+template <typename Class, typename Member>
+struct member_pointer_traits<Member Class::*> {
+  using class_type = Class;
+  using member_type = Member;
+};
+
+/// True if `Base` is `Derived` or an unambiguous non-virtual base of it:
+/// a pointer to such a base converts to `Derived*` with `static_cast`
+template <typename Base, typename Derived, typename = void>
+struct is_non_virtual_base : std::false_type {};
+
+template <typename Base, typename Derived>
+struct is_non_virtual_base<
+    Base, Derived,
+    std::void_t<decltype(static_cast<Derived*>(std::declval<Base*>()))>>
+    : std::is_base_of<Base, Derived> {};
+
+/// Offset of the `Base` subobject in a `Derived`, `Base` being a non-virtual
+/// base: the conversion adds a constant to a dummy pointer, which is never
+/// dereferenced
+template <typename Derived, typename Base>
+std::ptrdiff_t base_offset() noexcept {
+  const std::uintptr_t dummy = alignof(Derived) * 64;
+  auto derived = reinterpret_cast<Derived*>(dummy);
+  return static_cast<std::ptrdiff_t>(
+      reinterpret_cast<std::uintptr_t>(static_cast<Base*>(derived)) - dummy);
+}
+
+/// Offset of the data member `Member` in its class, from the member
+/// pointer alone
+template <auto Member>
+std::ptrdiff_t member_offset() noexcept {
+#if defined(__GNUC__)
+  // Itanium C++ ABI: a pointer to data member holds the member's offset
+  static_assert(sizeof(Member) == sizeof(std::ptrdiff_t));
+  auto pointer = Member;
+  std::ptrdiff_t result;
+  std::memcpy(&result, &pointer, sizeof(result));
+  return result;
+#else
+  using class_type =
+      typename member_pointer_traits<decltype(Member)>::class_type;
+  const std::uintptr_t dummy = alignof(class_type) * 64;
+  auto object = reinterpret_cast<const class_type*>(dummy);
+  return static_cast<std::ptrdiff_t>(
+      reinterpret_cast<std::uintptr_t>(&(object->*Member)) - dummy);
+#endif
+}
+
+template <typename T, auto Member>
+struct hook_traits<T, member_hook<Member>> {
+  using hook_type =
+      typename member_pointer_traits<decltype(Member)>::member_type;
+
+  using class_type =
+      typename member_pointer_traits<decltype(Member)>::class_type;
+
+  static_assert(std::is_base_of_v<list_base, hook_type>,
+                "Member should point to a list_element");
+  static_assert(is_non_virtual_base<class_type, T>::value,
+                "Member should point to a data member of T or of a "
+                "non-virtual base of T");
+
+  static hook_type* to_hook(T* val) noexcept {
+    return &(val->*Member);
+  }
+
+  static T* to_value(list_base* node) noexcept {
+    auto hook = reinterpret_cast<char*>(static_cast<hook_type*>(node));
+    return reinterpret_cast<T*>(hook - offset());
+  }
+
+private:
+  static std::ptrdiff_t offset() noexcept {
+    return base_offset<T, class_type>() + member_offset<Member>();
+  }
+};
+
+} // namespace detail
+
+template <typename T, typename Tag = default_tag,
+          typename SizePolicy = linear_time_size>
+struct list {
+  using value_traits = detail::hook_traits<T, Tag>;
+  using hook_type = typename value_traits::hook_type;
+
+  static_assert(std::is_same_v<SizePolicy, linear_time_size> ||
+                    std::is_same_v<SizePolicy, constant_time_size>,
+                "SizePolicy should be linear_time_size or constant_time_size");
+
+  static constexpr bool constant_time_size_v =
+      std::is_same_v<SizePolicy, constant_time_size>;
+  static constexpr link_mode mode = hook_type::mode;
+
+  using size_type = std::size_t;
+
   list() = default;
-  list(list&& other) = default;
+
+  list(list&& other) noexcept : counter{std::exchange(other.counter, {})} {
+    take_chain(other);
+  }
 
   list& operator=(list&& other) {
     if (this == &other) {
       return *this;
     }
     clear();
-    sentinel = std::move(other.sentinel);
+    take_chain(other);
+    counter = std::exchange(other.counter, {});
     assert(other.empty());
     return *this;
   }
@@ -81,11 +473,11 @@ struct list {
     generic_iterator(const iterator& iter) : data{iter.data} {}
 
     pointer operator->() const {
-      return static_cast<pointer>(static_cast<list_element<Tag>*>(data));
+      return value_traits::to_value(data);
     }
 
     reference operator*() const {
-      return static_cast<reference>(static_cast<list_element<Tag>&>(*data));
+      return *value_traits::to_value(data);
     }
 
     generic_iterator& operator++() {
@@ -122,7 +514,7 @@ struct list {
 
   private:
     explicit generic_iterator(detail::list_base* data_) : data{data_} {};
-    friend list<T, Tag>;
+    friend list;
 
     detail::list_base* data{nullptr};
   };
@@ -135,9 +527,28 @@ struct list {
     insert(begin(), val);
   }
 
+  /// O(1) with `link_mode::normal`, otherwise resets every element
   void clear() noexcept {
-    while (!empty()) {
-      pop_back();
+    if constexpr (mode == link_mode::normal) {
+      sentinel.prev = sentinel.next = &sentinel;
+      counter = {};
+    } else {
+      clear_and_dispose([](T&) {});
+    }
+  }
+
+  /// Unlinks every element and passes it to `dispose`, touching each node
+  /// once. The disposer may destroy the element
+  template <typename Disposer>
+  void clear_and_dispose(Disposer dispose) {
+    detail::list_base* node = sentinel.next;
+    sentinel.prev = sentinel.next = &sentinel;
+    counter = {};
+    while (node != &sentinel) {
+      detail::list_base* next = node->next;
+      release(node);
+      dispose(value_of(node));
+      node = next;
     }
   }
 
@@ -166,7 +577,18 @@ struct list {
   }
 
   bool empty() const noexcept {
-    return sentinel.prev == &sentinel && sentinel.next == &sentinel;
+    // `next` alone decides: loading both links lets the compiler merge them
+    // into one wide load, which stalls right after the links were stored
+    return sentinel.next == &sentinel;
+  }
+
+  /// O(1) with `constant_time_size`, O(n) otherwise
+  size_type size() const noexcept {
+    if constexpr (constant_time_size_v) {
+      return counter.value;
+    } else {
+      return static_cast<size_type>(std::distance(begin(), end()));
+    }
   }
 
   iterator begin() noexcept {
@@ -185,26 +607,434 @@ struct list {
   }
 
   const_iterator end() const noexcept {
-    return const_iterator{const_cast<list_element<Tag>*>(&sentinel)};
+    return const_iterator{const_cast<hook_type*>(&sentinel)};
+  }
+
+  /// Iterator to `val`, which must be contained in this list. O(1)
+  iterator iterator_to(T& val) noexcept {
+    return s_iterator_to(val);
+  }
+
+  const_iterator iterator_to(const T& val) const noexcept {
+    return s_iterator_to(val);
+  }
+
+  /// Same as `iterator_to`, but doesn't need the list itself
+  static iterator s_iterator_to(T& val) noexcept {
+    auto ptr = value_traits::to_hook(&val);
+    assert(mode == link_mode::normal || !ptr->is_single());
+    return iterator{ptr};
+  }
+
+  static const_iterator s_iterator_to(const T& val) noexcept {
+    return s_iterator_to(const_cast<T&>(val));
   }
 
   iterator insert(const_iterator it, T& val) noexcept {
     // if we want to insert the element before itself, the list_base::insert
     // will already deal with this
-    auto ptr = static_cast<list_element<Tag>*>(&val);
-    it.data->insert(*ptr);
+    auto ptr = value_traits::to_hook(&val);
+    if constexpr (constant_time_size_v) {
+      // the element can't be silently stolen from another list, since that
+      // list's counter would go stale
+      assert(mode == link_mode::normal || ptr->is_single());
+      ++counter.value;
+    }
+    if constexpr (mode == link_mode::safe && hook_type::head_aware) {
+      if (it.data != ptr) {
+        ptr->unlink_any();
+        it.data->link_before(*ptr);
+      }
+    } else if constexpr (mode == link_mode::safe) {
+      it.data->insert(*ptr);
+    } else {
+      // with other modes an element has to be unlinked before insertion
+      assert(mode == link_mode::normal || ptr->is_single());
+      it.data->link_before(*ptr);
+    }
     return iterator{ptr};
   }
 
+  /// Inserts the elements referenced by [first, last) before `pos`. They're
+  /// linked into a private chain first, which is then attached with a single
+  /// splice. `pos` must not refer to one of the inserted elements
+  template <typename InputIt>
+  iterator insert(const_iterator pos, InputIt first, InputIt last) {
+    if (first == last) {
+      return iterator{pos.data};
+    }
+    // NOTE: `first` is advanced before its element is acquired: acquiring
+    // unlinks the element, so `first` may be an iterator into another list
+    T& head = *first;
+    ++first;
+    detail::list_base* chain_first = acquire(head);
+    detail::list_base* chain_last = chain_first;
+    size_type count = 1;
+    while (first != last) {
+      T& val = *first;
+      ++first;
+      detail::list_base* node = acquire(val);
+      chain_last->next = node;
+      node->prev = chain_last;
+      chain_last = node;
+      ++count;
+    }
+
+    detail::list_base* before = pos.data->prev;
+    before->next = chain_first;
+    chain_first->prev = before;
+    chain_last->next = pos.data;
+    pos.data->prev = chain_last;
+    if constexpr (constant_time_size_v) {
+      counter.value += count;
+    } else {
+      static_cast<void>(count);
+    }
+    return iterator{chain_first};
+  }
+
+  iterator insert(const_iterator pos,
+                  std::initializer_list<std::reference_wrapper<T>> values) {
+    return insert(pos, values.begin(), values.end());
+  }
+
   iterator erase(iterator it) noexcept {
     assert(!empty());
     iterator old = it++;
-    old.data->unlink();
+    old.data->detach();
+    release(old.data);
+    if constexpr (constant_time_size_v) {
+      --counter.value;
+    }
     return it;
   }
 
+  /// Erases the element and passes it to `dispose`, which may destroy it
+  template <typename Disposer>
+  iterator erase_and_dispose(const_iterator it, Disposer dispose) {
+    T& val = const_cast<T&>(*it);
+    iterator result = erase(iterator{it.data});
+    dispose(val);
+    return result;
+  }
+
+  iterator erase(const_iterator first, const_iterator last) noexcept {
+    return erase_and_dispose(first, last, [](T&) {});
+  }
+
+  /// Erases every element of `victims`, which must all be contained in
+  /// this list, in any order and possibly adjacent to each other
+  void erase_batch(std::span<T* const> victims) noexcept {
+    erase_and_dispose_batch(victims, [](T&) {});
+  }
+
+  /// Same as `erase_batch`, passing every element to `dispose` right after
+  /// it's unlinked. Software pipelined: while a victim is unlinked, the
+  /// neighbours of a victim a few places ahead are prefetched, and the
+  /// victim after that is prefetched to learn its neighbours. Links are
+  /// read again when a victim is actually unlinked, so neighbours changed
+  /// by earlier erasures of the batch don't matter
+  template <typename Disposer>
+  void erase_and_dispose_batch(std::span<T* const> victims,
+                               Disposer dispose) {
+    constexpr std::size_t distance = 8;
+    for (std::size_t i = 0; i < victims.size(); ++i) {
+      if (i + 2 * distance < victims.size()) {
+        detail::prefetch_for_write(
+            value_traits::to_hook(victims[i + 2 * distance]));
+      }
+      if (i + distance < victims.size()) {
+        detail::list_base* ahead = value_traits::to_hook(victims[i + distance]);
+        detail::prefetch_for_write(ahead->prev);
+        detail::prefetch_for_write(ahead->next);
+      }
+      detail::list_base* node = value_traits::to_hook(victims[i]);
+      assert(mode == link_mode::normal || !node->is_single());
+      node->detach();
+      release(node);
+      if constexpr (constant_time_size_v) {
+        --counter.value;
+      }
+      dispose(*victims[i]);
+    }
+  }
+
+  /// Erases [first, last) passing every element to `dispose`. The
+  /// neighbours of the range are relinked once
+  template <typename Disposer>
+  iterator erase_and_dispose(const_iterator first, const_iterator last,
+                             Disposer dispose) {
+    if (first == last) {
+      return iterator{last.data};
+    }
+    detail::list_base* before = first.data->prev;
+    before->next = last.data;
+    last.data->prev = before;
+    for (detail::list_base* node = first.data; node != last.data;) {
+      detail::list_base* next = node->next;
+      if constexpr (constant_time_size_v) {
+        --counter.value;
+      }
+      release(node);
+      dispose(value_of(node));
+      node = next;
+    }
+    return iterator{last.data};
+  }
+
+  /// Erases all elements satisfying `pred`, returns their number
+  template <typename Predicate>
+  size_type remove_if(Predicate pred) {
+    return remove_and_dispose_if(pred, [](T&) {});
+  }
+
+  /// Erases all elements satisfying `pred` in a single pass, passing each
+  /// of them to `dispose`. Returns the number of erased elements
+  template <typename Predicate, typename Disposer>
+  size_type remove_and_dispose_if(Predicate pred, Disposer dispose) {
+    size_type removed = 0;
+    for (detail::list_base* node = sentinel.next; node != &sentinel;) {
+      detail::list_base* next = node->next;
+      if (pred(std::as_const(value_of(node)))) {
+        node->detach();
+        release(node);
+        dispose(value_of(node));
+        ++removed;
+      }
+      node = next;
+    }
+    if constexpr (constant_time_size_v) {
+      counter.value -= removed;
+    }
+    return removed;
+  }
+
+  /// Moves [first, last) from `other` before `pos`. With `constant_time_size`
+  /// this has to count the range unless it's the whole `other`, prefer the
+  /// overload taking the count then
   void splice(const_iterator pos, list& other, const_iterator first,
               const_iterator last) noexcept {
+    size_type count = 0;
+    if constexpr (constant_time_size_v) {
+      if (this != &other) {
+        count = first == other.begin() && last == other.end()
+                  ? other.size()
+                  : static_cast<size_type>(std::distance(first, last));
+      }
+    }
+    splice(pos, other, first, last, count);
+  }
+
+  /// Same as above, but the caller supplies `count == distance(first, last)`
+  /// so the counters are updated in O(1)
+  void splice(const_iterator pos, list& other, const_iterator first,
+              const_iterator last, size_type count) noexcept {
+    if constexpr (constant_time_size_v) {
+      assert(this == &other ||
+             count == static_cast<size_type>(std::distance(first, last)));
+      if (this != &other) {
+        other.counter.value -= count;
+        counter.value += count;
+      }
+    } else {
+      static_cast<void>(count);
+    }
+    splice_impl(pos, first, last);
+  }
+
+  /// Moves all elements of `other` before `pos`
+  void splice(const_iterator pos, list& other) noexcept {
+    splice(pos, other, other.begin(), other.end(),
+           constant_time_size_v ? other.size() : 0);
+  }
+
+  /// Merges sorted `other` into this sorted list by relinking its nodes.
+  /// Stable: equivalent elements of this list go before those of `other`.
+  /// If `comp` throws, both lists stay valid, the elements merged so far
+  /// being in this one
+  template <typename Compare = std::less<>>
+  void merge(list& other, Compare comp = {}) {
+    if (this == &other) {
+      return;
+    }
+    iterator it = begin();
+    while (it != end() && !other.empty()) {
+      if (!comp(other.front(), *it)) {
+        ++it;
+        continue;
+      }
+      // move the whole run of `other` that goes before `*it` at once
+      iterator run_end = std::next(other.begin());
+      size_type run = 1;
+      while (run_end != other.end() && comp(*run_end, *it)) {
+        ++run_end;
+        ++run;
+      }
+      splice_impl(it, other.begin(), run_end);
+      // counted per run, so a throwing `comp` leaves them right
+      if constexpr (constant_time_size_v) {
+        counter.value += run;
+        other.counter.value -= run;
+      } else {
+        static_cast<void>(run);
+      }
+    }
+    splice_impl(end(), other.begin(), other.end());
+    if constexpr (constant_time_size_v) {
+      counter.value += std::exchange(other.counter.value, 0);
+    }
+  }
+
+  /// Stable O(n log n) merge sort, relinks nodes in place and doesn't
+  /// allocate. If `comp` throws, the list keeps all its elements, in an
+  /// unspecified order
+  template <typename Compare = std::less<>>
+  void sort(Compare comp = {}) {
+    if (empty() || sentinel.next->next == &sentinel) {
+      return;
+    }
+    // Bottom-up merge of null-terminated chains that only follow `next`,
+    // `prev` pointers are restored in a single pass at the end.
+    // buckets[i] is either empty or holds a sorted run of 2^i elements
+    // taken from the list before the runs in buckets[0..i)
+    constexpr std::size_t bucket_count = 64;
+    detail::list_base* buckets[bucket_count]{};
+    std::size_t fill = 0;
+
+    sentinel.prev->next = nullptr;
+    detail::list_base* rest = sentinel.next;
+    detail::list_base* result = nullptr;
+    try {
+      while (rest != nullptr) {
+        detail::list_base* carry = rest;
+        rest = rest->next;
+        carry->next = nullptr;
+
+        std::size_t i = 0;
+        for (; i < fill && buckets[i] != nullptr; ++i) {
+          merge_chains(buckets[i], carry, comp);
+          carry = std::exchange(buckets[i], nullptr);
+        }
+        buckets[i] = carry;
+        if (i == fill) {
+          ++fill;
+        }
+      }
+
+      for (std::size_t i = 0; i < fill; ++i) {
+        if (buckets[i] != nullptr) {
+          if (result != nullptr) {
+            merge_chains(buckets[i], result, comp);
+          }
+          result = std::exchange(buckets[i], nullptr);
+        }
+      }
+    } catch (...) {
+      // a failed merge leaves both of its chains in its bucket, so every
+      // node is in a bucket or in `rest`
+      detail::list_base* prev = &sentinel;
+      for (std::size_t i = 0; i < fill; ++i) {
+        prev = relink_chain(prev, buckets[i]);
+      }
+      prev = relink_chain(prev, rest);
+      prev->next = &sentinel;
+      sentinel.prev = prev;
+      throw;
+    }
+
+    detail::list_base* prev = relink_chain(&sentinel, result);
+    prev->next = &sentinel;
+    sentinel.prev = prev;
+  }
+
+  ~list() {
+    clear();
+  }
+
+  hook_type sentinel;
+
+private:
+  // The sentinel is always transplanted, even when elements' hooks don't
+  // move with them (see link_mode::normal)
+  void take_chain(list& other) noexcept {
+    static_cast<detail::list_base&>(sentinel) =
+        std::move(static_cast<detail::list_base&>(other.sentinel));
+  }
+
+  static T& value_of(detail::list_base* node) noexcept {
+    return *value_traits::to_value(node);
+  }
+
+  /// Prepares an element for being linked into this list as if by `insert`
+  static detail::list_base* acquire(T& val) noexcept {
+    auto ptr = value_traits::to_hook(&val);
+    if constexpr (mode == link_mode::safe && !constant_time_size_v) {
+      if constexpr (hook_type::head_aware) {
+        ptr->unlink_any();
+      } else {
+        ptr->unlink();
+      }
+    } else {
+      assert(mode == link_mode::normal || ptr->is_single());
+    }
+    return ptr;
+  }
+
+  /// Brings an element already bypassed by its neighbours to the state its
+  /// link mode expects of an erased element
+  static void release(detail::list_base* node) noexcept {
+    if constexpr (mode != link_mode::normal) {
+      node->prev = node->next = node;
+    }
+  }
+
+  /// Merges the sorted null-terminated chain `right` into `left`, chains
+  /// linked by `next` only. Elements of `left` go first among equivalent
+  /// ones. If `comp` throws, `left` is one chain of all the nodes of both
+  template <typename Compare>
+  static void merge_chains(detail::list_base*& left,
+                           detail::list_base* right, Compare& comp) {
+    detail::list_base* head = nullptr;
+    detail::list_base** tail = &head;
+    detail::list_base* rest = left;
+    try {
+      while (rest != nullptr && right != nullptr) {
+        if (comp(value_of(right), value_of(rest))) {
+          *tail = right;
+          right = right->next;
+        } else {
+          *tail = rest;
+          rest = rest->next;
+        }
+        tail = &(*tail)->next;
+      }
+    } catch (...) {
+      *tail = rest;
+      while (*tail != nullptr) {
+        tail = &(*tail)->next;
+      }
+      *tail = right;
+      left = head;
+      throw;
+    }
+    *tail = rest != nullptr ? rest : right;
+    left = head;
+  }
+
+  /// Links the null-terminated chain `chain` after `prev`, restoring the
+  /// `prev` pointers, returns its last node (`prev` for an empty chain)
+  static detail::list_base* relink_chain(detail::list_base* prev,
+                                         detail::list_base* chain) noexcept {
+    for (; chain != nullptr; chain = chain->next) {
+      chain->prev = prev;
+      prev->next = chain;
+      prev = chain;
+    }
+    return prev;
+  }
+
+  void splice_impl(const_iterator pos, const_iterator first,
+                   const_iterator last) noexcept {
     if (first == last) {
       return;
     }
@@ -219,11 +1049,9 @@ struct list {
     pos.data->prev = last.data;
   }
 
-  ~list() {
-    clear();
-  }
-
-  list_element<Tag> sentinel;
+  [[no_unique_address]] std::conditional_t<constant_time_size_v,
+                                           detail::size_counter,
+                                           detail::no_size_counter> counter;
 };
 
 } // namespace intrusive
@@ -0,0 +1,341 @@
+#pragma once
+
+#include "intrusive_list.h"
+#include "intrusive_platform.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+
+namespace intrusive {
+namespace detail {
+
+/// LSD passes of `radix_sort` over a null-terminated chain linked by `next`.
+/// If `ordered_key` throws, `chain` still holds all the nodes
+template <std::size_t RadixBits, typename UnsignedKey, typename OrderedKey>
+void radix_sort_passes(list_base*& chain, UnsignedKey varying_bits,
+                       OrderedKey& ordered_key) {
+  using access = list_access;
+  constexpr std::size_t key_bits = sizeof(UnsignedKey) * CHAR_BIT;
+  constexpr std::size_t radix = std::size_t{1} << RadixBits;
+
+  list_base* heads[radix];
+  list_base** tails[radix];
+  // concatenates the buckets into `chain`, followed by `rest`
+  auto gather = [&](list_base* rest) {
+    list_base** out = &chain;
+    for (std::size_t digit = 0; digit < radix; ++digit) {
+      if (tails[digit] != &heads[digit]) {
+        *out = heads[digit];
+        out = tails[digit];
+      }
+    }
+    *out = rest;
+  };
+  for (std::size_t shift = 0; shift < key_bits; shift += RadixBits) {
+    if (((varying_bits >> shift) & (radix - 1)) == 0) {
+      continue;
+    }
+    for (std::size_t digit = 0; digit < radix; ++digit) {
+      tails[digit] = &heads[digit];
+    }
+    list_base* node = chain;
+    try {
+      for (; node != nullptr; node = access::next(*node)) {
+        auto digit = static_cast<std::size_t>((ordered_key(node) >> shift) &
+                                              (radix - 1));
+        *tails[digit] = node;
+        tails[digit] = &access::next(*node);
+      }
+    } catch (...) {
+      gather(node);
+      throw;
+    }
+    gather(nullptr);
+  }
+}
+
+} // namespace detail
+
+/// Stable LSD radix sort by an integral key. Each pass distributes the
+/// nodes by one digit of the key into bucket chains and concatenates them
+/// back, passes over digits that are equal for all keys are skipped. Long
+/// lists use 11-bit digits to save passes, since every pass is a full
+/// pointer chase. Only `next` links are maintained during the passes,
+/// `prev` links are restored once at the end. Doesn't allocate. If `key`
+/// throws, `l` keeps all its elements, in an unspecified order
+template <typename T, typename Tag, typename SizePolicy,
+          typename KeyProjection>
+void radix_sort(list<T, Tag, SizePolicy>& l, KeyProjection key) {
+  using list_type = list<T, Tag, SizePolicy>;
+  using value_traits = typename list_type::value_traits;
+  using key_type = std::remove_cv_t<
+      std::remove_reference_t<std::invoke_result_t<KeyProjection&, T&>>>;
+  static_assert(std::is_integral_v<key_type> &&
+                    !std::is_same_v<key_type, bool>,
+                "KeyProjection should return an integral key");
+  using unsigned_key = std::make_unsigned_t<key_type>;
+  using access = detail::list_access;
+  constexpr std::size_t key_bits = sizeof(key_type) * CHAR_BIT;
+  constexpr std::size_t long_list = std::size_t{1} << 16;
+
+  auto ordered_key = [&key](detail::list_base* node) {
+    T& val = *value_traits::to_value(node);
+    auto result = static_cast<unsigned_key>(std::invoke(key, val));
+    if constexpr (std::is_signed_v<key_type>) {
+      // flip the sign bit so negative keys go first
+      result ^= unsigned_key{1} << (key_bits - 1);
+    }
+    return result;
+  };
+
+  detail::list_base& sentinel = l.sentinel;
+  if (l.empty()) {
+    return;
+  }
+  unsigned_key first_key = ordered_key(access::next(sentinel));
+  unsigned_key varying_bits = 0;
+  std::size_t length = 0;
+  for (auto node = access::next(sentinel); node != &sentinel;
+       node = access::next(*node)) {
+    varying_bits |= ordered_key(node) ^ first_key;
+    ++length;
+  }
+  if (varying_bits == 0) {
+    return;
+  }
+
+  access::next(*access::prev(sentinel)) = nullptr;
+  detail::list_base* chain = access::next(sentinel);
+  auto relink = [&] {
+    detail::list_base* prev = &sentinel;
+    for (auto node = chain; node != nullptr; node = access::next(*node)) {
+      access::prev(*node) = prev;
+      access::next(*prev) = node;
+      prev = node;
+    }
+    access::next(*prev) = &sentinel;
+    access::prev(sentinel) = prev;
+  };
+  try {
+    if (length < long_list) {
+      detail::radix_sort_passes<8>(chain, varying_bits, ordered_key);
+    } else {
+      detail::radix_sort_passes<11>(chain, varying_bits, ordered_key);
+    }
+  } catch (...) {
+    relink();
+    throw;
+  }
+  relink();
+}
+
+/// Moves every element of `l` into storage obtained from `arena` in list
+/// order, so that with a bump allocator such as
+/// `std::pmr::monotonic_buffer_resource` traversal order matches address
+/// order again. `arena.allocate(bytes, alignment)` provides memory for one
+/// element, which is move constructed there, taking over the place of the
+/// old one in `l` through its hook. The old element is then passed to
+/// `dispose`, which is responsible for destroying and freeing it. If an
+/// allocation throws, the elements relocated so far stay relocated
+template <typename T, typename Tag, typename SizePolicy, typename Arena,
+          typename Disposer>
+void relayout(list<T, Tag, SizePolicy>& l, Arena& arena, Disposer dispose) {
+  static_assert(list<T, Tag, SizePolicy>::mode != link_mode::normal,
+                "Hooks in link_mode::normal don't move with their element");
+  static_assert(std::is_nothrow_move_constructible_v<T>,
+                "T should be nothrow move constructible");
+  for (auto it = l.begin(); it != l.end();) {
+    T& old = *it;
+    void* storage = arena.allocate(sizeof(T), alignof(T));
+    T* fresh = ::new (storage) T(std::move(old));
+    it = std::next(l.iterator_to(*fresh));
+    dispose(old);
+  }
+}
+
+/// Calls `f` on every element of `l` in order while a lead cursor runs
+/// `distance` (at most 15) nodes ahead, prefetching each node it reaches.
+/// The nodes between the two are kept in a ring, so the walk doesn't chase
+/// them twice and the load of the next link is issued before `f` runs on
+/// an element that's already in cache. Helps when `f` does enough work to
+/// hide part of a miss; `f` may erase the element it's given, but no other
+template <typename T, typename Tag, typename SizePolicy, typename F>
+void for_each_prefetch(list<T, Tag, SizePolicy>& l, F f,
+                       std::size_t distance = 4) {
+  using value_traits = typename list<T, Tag, SizePolicy>::value_traits;
+  using access = detail::list_access;
+  constexpr std::size_t ring_size = 16;
+  constexpr std::size_t mask = ring_size - 1;
+  distance = std::clamp<std::size_t>(distance, 1, ring_size - 1);
+
+  detail::list_base* const end = &l.sentinel;
+  detail::list_base* ring[ring_size];
+  std::size_t head = 0;
+  std::size_t tail = 0;
+  detail::list_base* newest = access::next(*end);
+  if (newest == end) {
+    return;
+  }
+  detail::prefetch(newest);
+  ring[tail++] = newest;
+  while (tail < distance) {
+    detail::list_base* next = access::next(*newest);
+    if (next == end) {
+      break;
+    }
+    detail::prefetch(next);
+    ring[tail++] = newest = next;
+  }
+
+  while (head != tail) {
+    if (newest != end) {
+      // `newest` was prefetched at least one call of `f` ago
+      newest = access::next(*newest);
+      if (newest != end) {
+        detail::prefetch(newest);
+        ring[tail++ & mask] = newest;
+      }
+    }
+    std::invoke(f, *value_traits::to_value(ring[head++ & mask]));
+  }
+}
+
+/// Calls `f` on every element of every list in `lists`, advancing up to
+/// `Width` lists in lockstep: each round takes one step in every active
+/// list, so their independent cache misses are in flight at the same time
+/// instead of one pointer chase after another. A list that ends is replaced
+/// by the next non-empty one. Elements of one list are visited in order,
+/// elements of different lists interleave. `lists` is any contiguous range
+/// of pointers to lists of one type: a `std::vector<list<T>*>`, an array or
+/// a `std::span`. `f` may erase the element it's given, but no other
+template <std::size_t Width = 8, typename Lists, typename F>
+void interleaved_for_each(Lists&& lists_range, F f) {
+  static_assert(Width > 0, "Width should be positive");
+  using list_type = std::remove_pointer_t<
+      std::remove_cvref_t<decltype(*std::data(lists_range))>>;
+  using value_traits = typename list_type::value_traits;
+  using access = detail::list_access;
+  std::span<list_type* const> lists{lists_range};
+
+  struct cursor {
+    detail::list_base* node;
+    detail::list_base* end;
+  };
+  cursor cursors[Width];
+  std::size_t active = 0;
+  std::size_t next_list = 0;
+  auto start_next_list = [&](cursor& c) {
+    while (next_list < lists.size()) {
+      auto* l = lists[next_list++];
+      if (!l->empty()) {
+        c = {access::next(l->sentinel), &l->sentinel};
+        detail::prefetch(c.node);
+        return true;
+      }
+    }
+    return false;
+  };
+
+  while (active < Width && start_next_list(cursors[active])) {
+    ++active;
+  }
+  while (active > 0) {
+    for (std::size_t i = 0; i < active;) {
+      cursor& c = cursors[i];
+      detail::list_base* node = c.node;
+      c.node = access::next(*node);
+      std::invoke(f, *value_traits::to_value(node));
+      if (c.node != c.end) {
+        detail::prefetch(c.node);
+      } else if (!start_next_list(c)) {
+        c = cursors[--active];
+        continue;
+      }
+      ++i;
+    }
+  }
+}
+
+/// Forward iterator over [first, last) of any container, which keeps the
+/// iterators to the next `Distance` elements in a ring and prefetches each
+/// element as it enters the ring. Advancing it increments only the newest
+/// iterator of the ring, whose element was prefetched on the previous
+/// increment. Copying it copies the ring
+template <typename Iter, std::size_t Distance = 4>
+struct prefetching_iterator {
+  static_assert(Distance > 0, "Distance should be positive");
+
+  using value_type = typename std::iterator_traits<Iter>::value_type;
+  using difference_type = typename std::iterator_traits<Iter>::difference_type;
+  using iterator_category = std::forward_iterator_tag;
+  using pointer = typename std::iterator_traits<Iter>::pointer;
+  using reference = typename std::iterator_traits<Iter>::reference;
+
+  prefetching_iterator() = default;
+
+  /// `prefetching_iterator(last, last)` is the matching end iterator
+  prefetching_iterator(Iter first, Iter last) : last{last} {
+    for (std::size_t i = 0; i < ring_size; ++i) {
+      ring[i] = first;
+      if (first != last) {
+        detail::prefetch(std::addressof(*first));
+        if (i + 1 < ring_size) {
+          ++first;
+        }
+      }
+    }
+  }
+
+  reference operator*() const {
+    return *ring[pos];
+  }
+
+  pointer operator->() const {
+    return std::addressof(*ring[pos]);
+  }
+
+  prefetching_iterator& operator++() {
+    Iter newest = ring[(pos + Distance) % ring_size];
+    if (newest != last) {
+      ++newest;
+      if (newest != last) {
+        detail::prefetch(std::addressof(*newest));
+      }
+    }
+    ring[pos] = newest;
+    pos = (pos + 1) % ring_size;
+    return *this;
+  }
+
+  prefetching_iterator operator++(int) {
+    prefetching_iterator result = *this;
+    ++*this;
+    return result;
+  }
+
+  bool operator==(const prefetching_iterator& rhs) const {
+    return ring[pos] == rhs.ring[rhs.pos];
+  }
+
+  bool operator!=(const prefetching_iterator& rhs) const {
+    return !(*this == rhs);
+  }
+
+private:
+  static constexpr std::size_t ring_size = Distance + 1;
+
+  // ring[pos] is the current element, followed by the next ones
+  std::array<Iter, ring_size> ring{};
+  std::size_t pos{0};
+  Iter last{};
+};
+
+} // namespace intrusive
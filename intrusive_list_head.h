@@ -0,0 +1,223 @@
+#pragma once
+
+#include "intrusive_list.h"
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace intrusive {
+
+/// Null-terminated doubly linked list whose head is a single pointer to the
+/// first element, `nullptr` when empty, meant for large arrays of buckets.
+/// The first element's `prev` holds the tagged address of the head pointer,
+/// so elements can still unlink themselves in O(1), e.g. by being
+/// destroyed. This takes `list_head_element` hooks, which can be linked
+/// into a `list` as well; plain `list_element` hooks only with
+/// `link_mode::normal`, as they never unlink or move themselves. Iteration
+/// is forward only, there's no O(1) way to reach the last element
+template <typename T, typename Tag = default_tag>
+struct list_head {
+  using value_traits = detail::hook_traits<T, Tag>;
+  using hook_type = typename value_traits::hook_type;
+
+  static constexpr link_mode mode = hook_type::mode;
+
+  static_assert(mode == link_mode::normal || hook_type::head_aware,
+                "T should derive from list_head_element<Tag, Mode> unless "
+                "its hook is link_mode::normal");
+
+  list_head() = default;
+
+  list_head(list_head&& other) noexcept
+      : first{std::exchange(other.first, nullptr)} {
+    relink_first();
+  }
+
+  list_head& operator=(list_head&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    first = std::exchange(other.first, nullptr);
+    relink_first();
+    return *this;
+  }
+
+  template <bool Const>
+  struct generic_iterator;
+
+  using iterator = generic_iterator<false>;
+  using const_iterator = generic_iterator<true>;
+
+  template <bool Const>
+  struct generic_iterator {
+    using value_type = std::conditional_t<Const, const T, T>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    generic_iterator() = default;
+    generic_iterator(const generic_iterator& iter) = default;
+
+    template <bool Dummy = Const, typename = std::enable_if_t<Dummy>>
+    generic_iterator(const iterator& iter) : data{iter.data} {}
+
+    pointer operator->() const {
+      return value_traits::to_value(data);
+    }
+
+    reference operator*() const {
+      return *value_traits::to_value(data);
+    }
+
+    generic_iterator& operator++() {
+      data = access::next(*data);
+      return *this;
+    }
+
+    generic_iterator operator++(int) {
+      generic_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    template <bool ConstRhs>
+    bool operator==(const generic_iterator<ConstRhs>& rhs) const {
+      return data == rhs.data;
+    }
+
+    template <bool ConstRhs>
+    bool operator!=(const generic_iterator<ConstRhs>& rhs) const {
+      return data != rhs.data;
+    }
+
+  private:
+    explicit generic_iterator(detail::list_base* data_) : data{data_} {};
+    friend list_head;
+
+    detail::list_base* data{nullptr};
+  };
+
+  /// `val` must not be contained in any list
+  void push_front(T& val) noexcept {
+    detail::list_base* node = value_traits::to_hook(&val);
+    assert(mode == link_mode::normal || access::is_single(*node));
+    access::next(*node) = first;
+    if (first != nullptr) {
+      access::prev(*first) = node;
+    }
+    first = node;
+    access::prev(*node) = head_link();
+  }
+
+  void pop_front() noexcept {
+    erase(begin());
+  }
+
+  void clear() noexcept {
+    if constexpr (mode == link_mode::normal) {
+      first = nullptr;
+    } else {
+      while (!empty()) {
+        pop_front();
+      }
+    }
+  }
+
+  const T& front() const noexcept {
+    return *begin();
+  }
+
+  T& front() noexcept {
+    return *begin();
+  }
+
+  bool empty() const noexcept {
+    return first == nullptr;
+  }
+
+  iterator begin() noexcept {
+    return iterator{first};
+  }
+
+  const_iterator begin() const noexcept {
+    return const_iterator{first};
+  }
+
+  iterator end() noexcept {
+    return iterator{nullptr};
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator{nullptr};
+  }
+
+  /// Iterator to `val`, which must be contained in this list. O(1)
+  iterator iterator_to(T& val) noexcept {
+    return iterator{value_traits::to_hook(&val)};
+  }
+
+  const_iterator iterator_to(const T& val) const noexcept {
+    return const_iterator{value_traits::to_hook(const_cast<T*>(&val))};
+  }
+
+  /// Inserts `val` after `pos`, `val` must not be contained in any list
+  iterator insert_after(const_iterator pos, T& val) noexcept {
+    detail::list_base* node = value_traits::to_hook(&val);
+    assert(mode == link_mode::normal || access::is_single(*node));
+    detail::list_base* next = access::next(*pos.data);
+    access::prev(*node) = pos.data;
+    access::next(*node) = next;
+    if (next != nullptr) {
+      access::prev(*next) = node;
+    }
+    access::next(*pos.data) = node;
+    return iterator{node};
+  }
+
+  iterator erase(iterator it) noexcept {
+    detail::list_base* next = access::next(*it.data);
+    unlink(*it);
+    return iterator{next};
+  }
+
+  /// Removes `val` from whichever `list_head` contains it, the head itself
+  /// isn't needed
+  static void unlink(T& val) noexcept {
+    detail::list_base* node = value_traits::to_hook(&val);
+    if constexpr (mode == link_mode::normal) {
+      detail::list_base* next = access::next(*node);
+      access::incoming_link(*node) = next;
+      if (next != nullptr) {
+        access::prev(*next) = access::prev(*node);
+      }
+    } else {
+      access::unlink_any(*node);
+    }
+  }
+
+  ~list_head() {
+    clear();
+  }
+
+private:
+  using access = detail::list_access;
+
+  detail::list_base* head_link() noexcept {
+    return access::head_link(&first);
+  }
+
+  void relink_first() noexcept {
+    if (first != nullptr) {
+      access::prev(*first) = head_link();
+    }
+  }
+
+  detail::list_base* first{nullptr};
+};
+
+} // namespace intrusive
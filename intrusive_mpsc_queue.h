@@ -0,0 +1,98 @@
+#pragma once
+
+#include "intrusive_platform.h"
+#include "intrusive_slist.h"
+
+#include <atomic>
+#include <cassert>
+#include <type_traits>
+
+namespace intrusive {
+
+/// Unbounded multi-producer single-consumer FIFO queue of elements with an
+/// `atomic_slist_element<Tag>` hook, after Dmitry Vyukov's intrusive MPSC
+/// queue. Nothing is allocated: the elements are the queue nodes.
+/// - `push` may be called from any number of threads and is wait-free: a
+///   single exchange followed by a single store
+/// - `try_pop` and `empty` may only be called by one consumer thread at a
+///   time. `try_pop` may return nullptr while a producer is between its
+///   exchange and its store, even if elements pushed later are queued
+template <typename T, typename Tag = default_tag>
+struct mpsc_queue {
+  static_assert(std::is_base_of_v<atomic_slist_element<Tag>, T>,
+                "T should derive from atomic_slist_element<Tag>");
+
+  mpsc_queue() noexcept : head{&stub}, tail{&stub} {
+    stub.next.store(nullptr, std::memory_order_relaxed);
+  }
+
+  mpsc_queue(const mpsc_queue&) = delete;
+  mpsc_queue& operator=(const mpsc_queue&) = delete;
+
+  /// `val` must not be contained in any queue
+  void push(T& val) noexcept {
+    node* ptr = static_cast<atomic_slist_element<Tag>*>(&val);
+    assert(!ptr->is_linked());
+    push_node(ptr);
+  }
+
+  /// Removes the oldest element, nullptr if there's none or if it's still
+  /// being pushed
+  T* try_pop() noexcept {
+    node* first = tail;
+    node* next = first->next.load(std::memory_order_acquire);
+    if (first == &stub) {
+      if (next == nullptr) {
+        return nullptr;
+      }
+      tail = first = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+    if (next == nullptr) {
+      if (first != head.load(std::memory_order_acquire)) {
+        // a producer has taken `first` as its predecessor, but hasn't
+        // linked its element yet
+        return nullptr;
+      }
+      // `first` is the only element, the stub takes its place as the
+      // predecessor of future elements
+      push_node(&stub);
+      next = first->next.load(std::memory_order_acquire);
+      if (next == nullptr) {
+        return nullptr;
+      }
+    }
+    tail = next;
+    // nobody writes to `first` anymore: its successor has been linked
+    first->next.store(first, std::memory_order_relaxed);
+    return static_cast<T*>(static_cast<atomic_slist_element<Tag>*>(first));
+  }
+
+  /// Returns true if there are no elements, not counting those being pushed
+  /// concurrently. Consumer only
+  bool empty() const noexcept {
+    return tail == &stub &&
+           stub.next.load(std::memory_order_acquire) == nullptr;
+  }
+
+  ~mpsc_queue() {
+    assert(empty());
+  }
+
+private:
+  using node = detail::atomic_slist_base;
+
+  void push_node(node* ptr) noexcept {
+    ptr->next.store(nullptr, std::memory_order_relaxed);
+    node* prev = head.exchange(ptr, std::memory_order_acq_rel);
+    prev->next.store(ptr, std::memory_order_release);
+  }
+
+  // written by producers
+  alignas(detail::cache_line_size) std::atomic<node*> head;
+  // touched only by the consumer, apart from the stub's link
+  alignas(detail::cache_line_size) node* tail;
+  node stub;
+};
+
+} // namespace intrusive
@@ -0,0 +1,303 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace intrusive {
+struct default_tag;
+
+template <typename T, typename Tag>
+struct offset_list;
+
+template <typename Tag>
+struct offset_list_element;
+
+namespace detail {
+
+struct offset_list_base {
+  /// Link value referring to the head of the list the node is contained in
+  static constexpr std::uint32_t head_offset = UINT32_MAX;
+  /// NOTE: marker for non-connected node: prev == next == unlinked_offset
+  static constexpr std::uint32_t unlinked_offset = UINT32_MAX - 1;
+
+  constexpr offset_list_base() noexcept = default;
+
+  // Offsets are relative to the arena, so a copy can't take the place of
+  // the original in its list
+  constexpr offset_list_base(const offset_list_base&) noexcept
+      : offset_list_base{} {}
+
+  offset_list_base& operator=(const offset_list_base&) = delete;
+
+  ~offset_list_base() = default;
+
+private:
+  constexpr bool is_linked() const noexcept {
+    return next != unlinked_offset;
+  }
+
+  template <typename T, typename Tag>
+  friend struct ::intrusive::offset_list;
+
+  template <typename Tag>
+  friend struct ::intrusive::offset_list_element;
+
+  std::uint32_t prev{unlinked_offset};
+  std::uint32_t next{unlinked_offset};
+};
+
+} // namespace detail
+
+/// Hook storing its links as 32-bit byte offsets from the arena base of its
+/// list, so every element has to live within 4 GiB after that base. As the
+/// arena isn't known to the element, it can't unlink itself and must be
+/// erased before being destroyed
+template <typename Tag = default_tag>
+struct offset_list_element : public detail::offset_list_base {
+  constexpr ~offset_list_element() {
+    assert(!is_linked());
+  }
+};
+
+template <typename T, typename Tag = default_tag>
+struct offset_list {
+  static_assert(std::is_base_of_v<offset_list_element<Tag>, T>,
+                "T should derive from offset_list_element<Tag>");
+
+  explicit offset_list(void* arena_base) noexcept
+      : base{static_cast<std::byte*>(arena_base)} {}
+
+  offset_list(offset_list&& other) noexcept
+      : base{other.base},
+        first{std::exchange(other.first, head_offset)},
+        last{std::exchange(other.last, head_offset)} {}
+
+  offset_list& operator=(offset_list&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    base = other.base;
+    first = std::exchange(other.first, head_offset);
+    last = std::exchange(other.last, head_offset);
+    return *this;
+  }
+
+  template <bool Const>
+  struct generic_iterator;
+
+  using iterator = generic_iterator<false>;
+  using const_iterator = generic_iterator<true>;
+
+  template <bool Const>
+  struct generic_iterator {
+    using value_type = std::conditional_t<Const, const T, T>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    generic_iterator() = default;
+    generic_iterator(const generic_iterator& iter) = default;
+
+    template <bool Dummy = Const, typename = std::enable_if_t<Dummy>>
+    generic_iterator(const iterator& iter)
+        : owner{iter.owner}, offset{iter.offset} {}
+
+    pointer operator->() const {
+      return static_cast<pointer>(owner->element(offset));
+    }
+
+    reference operator*() const {
+      return *operator->();
+    }
+
+    generic_iterator& operator++() {
+      offset = owner->next_of(offset);
+      return *this;
+    }
+
+    generic_iterator operator++(int) {
+      generic_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    generic_iterator& operator--() {
+      offset = owner->prev_of(offset);
+      return *this;
+    }
+
+    generic_iterator operator--(int) {
+      generic_iterator result = *this;
+      --*this;
+      return result;
+    }
+
+    template <bool ConstRhs>
+    bool operator==(const generic_iterator<ConstRhs>& rhs) const {
+      return offset == rhs.offset;
+    }
+
+    template <bool ConstRhs>
+    bool operator!=(const generic_iterator<ConstRhs>& rhs) const {
+      return offset != rhs.offset;
+    }
+
+  private:
+    generic_iterator(const offset_list* owner_, std::uint32_t offset_)
+        : owner{owner_}, offset{offset_} {};
+    friend offset_list;
+
+    const offset_list* owner{nullptr};
+    std::uint32_t offset{head_offset};
+  };
+
+  void push_back(T& val) noexcept {
+    insert(end(), val);
+  }
+
+  void push_front(T& val) noexcept {
+    insert(begin(), val);
+  }
+
+  void clear() noexcept {
+    while (!empty()) {
+      pop_back();
+    }
+  }
+
+  void pop_back() noexcept {
+    erase(std::prev(end()));
+  }
+
+  void pop_front() noexcept {
+    erase(begin());
+  }
+
+  const T& back() const noexcept {
+    return *std::prev(end());
+  }
+
+  T& back() noexcept {
+    return *std::prev(end());
+  }
+
+  const T& front() const noexcept {
+    return *begin();
+  }
+
+  T& front() noexcept {
+    return *begin();
+  }
+
+  bool empty() const noexcept {
+    return first == head_offset;
+  }
+
+  iterator begin() noexcept {
+    return iterator{this, first};
+  }
+
+  const_iterator begin() const noexcept {
+    return const_iterator{this, first};
+  }
+
+  iterator end() noexcept {
+    return iterator{this, head_offset};
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator{this, head_offset};
+  }
+
+  /// `val` must lie in the arena and must not be contained in any list
+  iterator insert(const_iterator it, T& val) noexcept {
+    auto ptr = static_cast<offset_list_element<Tag>*>(&val);
+    assert(!ptr->is_linked());
+    std::uint32_t offset = offset_of(ptr);
+    std::uint32_t prev = prev_of(it.offset);
+
+    ptr->prev = prev;
+    ptr->next = it.offset;
+    next_link(prev) = offset;
+    prev_link(it.offset) = offset;
+    return iterator{this, offset};
+  }
+
+  iterator erase(iterator it) noexcept {
+    assert(!empty());
+    auto ptr = element(it.offset);
+    std::uint32_t next = ptr->next;
+    next_link(ptr->prev) = next;
+    prev_link(next) = ptr->prev;
+    ptr->prev = ptr->next = detail::offset_list_base::unlinked_offset;
+    return iterator{this, next};
+  }
+
+  /// `other` has to share the arena with this list
+  void splice(const_iterator pos, offset_list& other, const_iterator first_,
+              const_iterator last_) noexcept {
+    assert(base == other.base);
+    if (first_ == last_) {
+      return;
+    }
+    std::uint32_t range_first = first_.offset;
+    std::uint32_t range_last = other.prev_of(last_.offset);
+    std::uint32_t before_range = element(range_first)->prev;
+
+    other.next_link(before_range) = last_.offset;
+    other.prev_link(last_.offset) = before_range;
+
+    std::uint32_t prev = prev_of(pos.offset);
+    element(range_first)->prev = prev;
+    next_link(prev) = range_first;
+    element(range_last)->next = pos.offset;
+    prev_link(pos.offset) = range_last;
+  }
+
+  ~offset_list() {
+    clear();
+  }
+
+private:
+  static constexpr std::uint32_t head_offset =
+      detail::offset_list_base::head_offset;
+
+  offset_list_element<Tag>* element(std::uint32_t offset) const noexcept {
+    assert(offset < detail::offset_list_base::unlinked_offset);
+    return reinterpret_cast<offset_list_element<Tag>*>(base + offset);
+  }
+
+  std::uint32_t offset_of(const offset_list_element<Tag>* ptr) const noexcept {
+    auto offset = reinterpret_cast<const std::byte*>(ptr) - base;
+    assert(offset >= 0 && offset < detail::offset_list_base::unlinked_offset);
+    return static_cast<std::uint32_t>(offset);
+  }
+
+  std::uint32_t next_of(std::uint32_t offset) const noexcept {
+    return offset == head_offset ? first : element(offset)->next;
+  }
+
+  std::uint32_t prev_of(std::uint32_t offset) const noexcept {
+    return offset == head_offset ? last : element(offset)->prev;
+  }
+
+  std::uint32_t& next_link(std::uint32_t offset) noexcept {
+    return offset == head_offset ? first : element(offset)->next;
+  }
+
+  std::uint32_t& prev_link(std::uint32_t offset) noexcept {
+    return offset == head_offset ? last : element(offset)->prev;
+  }
+
+  std::byte* base;
+  std::uint32_t first{head_offset};
+  std::uint32_t last{head_offset};
+};
+
+} // namespace intrusive
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace intrusive {
+namespace detail {
+
+/// Assumed size of a cache line, used to keep data written by different
+/// threads apart. `std::hardware_destructive_interference_size` isn't used
+/// as its value may differ between translation units
+inline constexpr std::size_t cache_line_size = 64;
+
+/// Asks the CPU to start loading the cache line at `ptr` for reading, has
+/// no effect where the compiler has no intrinsic for it. Never faults
+inline void prefetch(const void* ptr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(ptr);
+#else
+  static_cast<void>(ptr);
+#endif
+}
+
+/// Same as `prefetch`, but for a line that's about to be written
+inline void prefetch_for_write(const void* ptr) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(ptr, 1);
+#else
+  static_cast<void>(ptr);
+#endif
+}
+
+/// Tells the CPU the caller is spinning on a value written by another
+/// thread, which saves power and frees resources for a sibling hyperthread
+inline void cpu_relax() noexcept {
+#if (defined(__GNUC__) || defined(__clang__)) &&                              \
+    (defined(__x86_64__) || defined(__i386__))
+  __builtin_ia32_pause();
+#elif (defined(__GNUC__) || defined(__clang__)) && defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+/// Small number unique to the calling thread, threads get consecutive
+/// numbers in the order they first ask for one
+inline std::size_t this_thread_index() noexcept {
+  static std::atomic<std::size_t> next_index{0};
+  thread_local const std::size_t index =
+      next_index.fetch_add(1, std::memory_order_relaxed);
+  return index;
+}
+
+} // namespace detail
+} // namespace intrusive
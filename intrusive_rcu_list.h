@@ -0,0 +1,353 @@
+#pragma once
+
+#include "intrusive_platform.h"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace intrusive {
+struct default_tag;
+
+template <typename T, typename Tag>
+struct rcu_list;
+
+template <typename Tag>
+struct rcu_list_element;
+
+namespace detail {
+
+/// Node of `rcu_list`. Readers only follow `next`, which is atomic; `prev`
+/// is used by writers holding the list's lock and, once the node has been
+/// erased, chains it to the other elements waiting for a grace period
+struct rcu_list_base {
+  // NOTE: marker for non-connected/sentinel node: prev == next == this
+  rcu_list_base() noexcept : next{this}, prev{this} {}
+
+  // Links aren't copied, the copy is a fresh node
+  rcu_list_base(const rcu_list_base&) noexcept : rcu_list_base{} {}
+
+  rcu_list_base& operator=(const rcu_list_base&) = delete;
+
+  ~rcu_list_base() = default;
+
+private:
+  rcu_list_base* load_next() const noexcept {
+    return next.load(std::memory_order_acquire);
+  }
+
+  bool is_single() const noexcept {
+    return prev == this && next.load(std::memory_order_relaxed) == this;
+  }
+
+  /// Inserts `other` before this node, readers see it only once its own
+  /// links are set
+  void link_before(rcu_list_base& other) noexcept {
+    other.prev = prev;
+    other.next.store(this, std::memory_order_relaxed);
+    prev->next.store(&other, std::memory_order_release);
+    prev = &other;
+  }
+
+  /// Takes the node out of the list for new readers. Its `next` is kept,
+  /// so readers standing on it can still go on
+  void bypass() noexcept {
+    rcu_list_base* succ = next.load(std::memory_order_relaxed);
+    prev->next.store(succ, std::memory_order_release);
+    succ->prev = prev;
+  }
+
+  void reset() noexcept {
+    prev = this;
+    next.store(this, std::memory_order_relaxed);
+  }
+
+  template <typename T, typename Tag>
+  friend struct ::intrusive::rcu_list;
+
+  template <typename Tag>
+  friend struct ::intrusive::rcu_list_element;
+
+  std::atomic<rcu_list_base*> next;
+  rcu_list_base* prev;
+};
+
+/// Counters of the readers inside a read-side critical section, one per
+/// parity of the epoch they entered in
+struct alignas(cache_line_size) rcu_reader_slot {
+  std::array<std::atomic<std::size_t>, 2> active{};
+};
+
+} // namespace detail
+
+/// Hook for `rcu_list`. Readers may be standing on an element even after
+/// it has been erased, so it doesn't unlink itself: it has to be erased
+/// and reclaimed before being destroyed
+template <typename Tag = default_tag>
+struct rcu_list_element : public detail::rcu_list_base {
+  rcu_list_element() noexcept = default;
+  rcu_list_element(const rcu_list_element&) noexcept = default;
+
+  ~rcu_list_element() {
+    assert(this->is_single());
+  }
+};
+
+/// Doubly linked list for read-mostly data, after read-copy-update.
+/// Readers take no lock: while holding a `read_guard` they walk the list
+/// forward with acquire loads and never block writers. Writers are
+/// serialized by an internal mutex and publish with release stores. An
+/// erased element is only retired: it stays readable, and is handed to a
+/// disposer by `reclaim` once every reader that might have seen it has
+/// dropped its guard (a grace period). Readers announce themselves in
+/// per-thread-index counters on separate cache lines, so concurrent
+/// readers write to different lines.
+/// - readers: `read_lock`, `begin`, `end`, `empty`
+/// - writers (any thread, no guard held): all the other members
+template <typename T, typename Tag = default_tag>
+struct rcu_list {
+  using hook_type = rcu_list_element<Tag>;
+  static_assert(std::is_base_of_v<hook_type, T>,
+                "T should derive from rcu_list_element<Tag>");
+
+  /// Number of reader counter pairs, threads share them by thread index
+  static constexpr std::size_t reader_slots = 16;
+
+  rcu_list() = default;
+
+  rcu_list(const rcu_list&) = delete;
+  rcu_list& operator=(const rcu_list&) = delete;
+
+  template <bool Const>
+  struct generic_iterator;
+
+  using iterator = generic_iterator<false>;
+  using const_iterator = generic_iterator<true>;
+
+  template <bool Const>
+  struct generic_iterator {
+    using value_type = std::conditional_t<Const, const T, T>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    generic_iterator() = default;
+    generic_iterator(const generic_iterator& iter) = default;
+
+    template <bool Dummy = Const, typename = std::enable_if_t<Dummy>>
+    generic_iterator(const iterator& iter) : data{iter.data} {}
+
+    pointer operator->() const {
+      return static_cast<pointer>(static_cast<hook_type*>(data));
+    }
+
+    reference operator*() const {
+      return *operator->();
+    }
+
+    generic_iterator& operator++() {
+      data = data->load_next();
+      return *this;
+    }
+
+    generic_iterator operator++(int) {
+      generic_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    template <bool ConstRhs>
+    bool operator==(const generic_iterator<ConstRhs>& rhs) const {
+      return data == rhs.data;
+    }
+
+    template <bool ConstRhs>
+    bool operator!=(const generic_iterator<ConstRhs>& rhs) const {
+      return data != rhs.data;
+    }
+
+  private:
+    explicit generic_iterator(detail::rcu_list_base* data_) : data{data_} {};
+    friend rcu_list;
+
+    detail::rcu_list_base* data{nullptr};
+  };
+
+  /// Read-side critical section: elements reached while it's alive aren't
+  /// reclaimed. Guards nest, but must not be held across `synchronize`
+  struct read_guard {
+    explicit read_guard(const rcu_list& list) noexcept
+        : slot{&list.readers[detail::this_thread_index() % reader_slots]},
+          parity{list.epoch.load(std::memory_order_relaxed) & 1} {
+      slot->active[parity].fetch_add(1, std::memory_order_seq_cst);
+      // pairs with the fence in `synchronize`: either the writer sees this
+      // reader, or the reader's loads see the bypassed links
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    read_guard(const read_guard&) = delete;
+    read_guard& operator=(const read_guard&) = delete;
+
+    ~read_guard() {
+      slot->active[parity].fetch_sub(1, std::memory_order_release);
+    }
+
+  private:
+    detail::rcu_reader_slot* slot;
+    std::size_t parity;
+  };
+
+  read_guard read_lock() const noexcept {
+    return read_guard{*this};
+  }
+
+  iterator begin() noexcept {
+    return iterator{sentinel.load_next()};
+  }
+
+  const_iterator begin() const noexcept {
+    return const_iterator{sentinel.load_next()};
+  }
+
+  iterator end() noexcept {
+    return iterator{&sentinel};
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator{const_cast<detail::rcu_list_base*>(&sentinel)};
+  }
+
+  bool empty() const noexcept {
+    return sentinel.load_next() == &sentinel;
+  }
+
+  /// Iterator to `val`, which must be contained in this list. O(1)
+  iterator iterator_to(T& val) noexcept {
+    return iterator{to_node(val)};
+  }
+
+  const_iterator iterator_to(const T& val) const noexcept {
+    return const_iterator{to_node(const_cast<T&>(val))};
+  }
+
+  void push_back(T& val) noexcept {
+    insert(end(), val);
+  }
+
+  void push_front(T& val) noexcept {
+    detail::rcu_list_base* node = to_node(val);
+    assert(node->is_single());
+    std::lock_guard guard{writer_lock};
+    sentinel.load_next()->link_before(*node);
+  }
+
+  /// Inserts `val` before `pos`, which must be `end()` or an element that
+  /// hasn't been erased. `val` must not be contained in any list
+  iterator insert(const_iterator pos, T& val) noexcept {
+    detail::rcu_list_base* node = to_node(val);
+    assert(node->is_single());
+    std::lock_guard guard{writer_lock};
+    pos.data->link_before(*node);
+    return iterator{node};
+  }
+
+  /// Retires `val`: new readers won't see it, current ones may still be
+  /// standing on it. It's disposed of by the next `reclaim`
+  void erase(T& val) noexcept {
+    detail::rcu_list_base* node = to_node(val);
+    std::lock_guard guard{writer_lock};
+    assert(!node->is_single());
+    node->bypass();
+    node->prev = retired;
+    retired = node;
+  }
+
+  /// Waits for a grace period, then passes every element retired before
+  /// the call to `dispose`, unlinked. The disposer may destroy the element
+  template <typename Disposer>
+  void reclaim(Disposer dispose) {
+    detail::rcu_list_base* chain;
+    {
+      std::lock_guard guard{writer_lock};
+      chain = std::exchange(retired, nullptr);
+    }
+    if (chain == nullptr) {
+      return;
+    }
+    synchronize();
+    while (chain != nullptr) {
+      detail::rcu_list_base* next = chain->prev;
+      chain->reset();
+      dispose(*static_cast<T*>(static_cast<hook_type*>(chain)));
+      chain = next;
+    }
+  }
+
+  /// Erases `val` and reclaims it, along with the other retired elements
+  template <typename Disposer>
+  void erase_and_dispose(T& val, Disposer dispose) {
+    erase(val);
+    reclaim(std::move(dispose));
+  }
+
+  /// Returns once every read guard alive at the time of the call has been
+  /// dropped. A reader entering during the call can delay it by at most
+  /// one critical section: one that reads the parity between the two flips
+  /// is waited for, one entering after the second flip never is
+  void synchronize() noexcept {
+    std::lock_guard guard{grace_lock};
+    // orders the unlinking stores before the epoch flips and the counter
+    // loads, pairs with the fence in `read_guard`
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // a reader that read the parity before a flip may raise the counter of
+    // the old one afterwards, the second flip waits for such readers
+    for (int round = 0; round < 2; ++round) {
+      std::size_t parity =
+          epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+      for (detail::rcu_reader_slot& slot : readers) {
+        for (unsigned spins = 0;
+             slot.active[parity].load(std::memory_order_seq_cst) != 0;
+             ++spins) {
+          if (spins < 64) {
+            detail::cpu_relax();
+          } else {
+            std::this_thread::yield();
+          }
+        }
+      }
+    }
+  }
+
+  /// No reader may be active, retired elements must have been reclaimed
+  ~rcu_list() {
+    assert(retired == nullptr);
+    for (detail::rcu_list_base* node = sentinel.load_next();
+         node != &sentinel;) {
+      detail::rcu_list_base* next = node->load_next();
+      node->reset();
+      node = next;
+    }
+  }
+
+private:
+  static detail::rcu_list_base* to_node(T& val) noexcept {
+    return static_cast<hook_type*>(&val);
+  }
+
+  // read by every reader, written by writers
+  alignas(detail::cache_line_size) std::atomic<std::size_t> epoch{0};
+  detail::rcu_list_base sentinel;
+  mutable std::array<detail::rcu_reader_slot, reader_slots> readers;
+  std::mutex writer_lock;
+  std::mutex grace_lock;
+  detail::rcu_list_base* retired{nullptr};
+};
+
+} // namespace intrusive
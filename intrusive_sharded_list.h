@@ -0,0 +1,145 @@
+#pragma once
+
+#include "intrusive_list.h"
+#include "intrusive_platform.h"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+
+namespace intrusive {
+namespace detail {
+
+/// Test-and-test-and-set lock for critical sections of a few pointer
+/// writes. Waiters spin on a plain load and yield the CPU after a while,
+/// so an owner that got preempted isn't starved by its waiters
+struct spinlock {
+  void lock() noexcept {
+    for (unsigned spins = 0;; ++spins) {
+      if (!locked.exchange(true, std::memory_order_acquire)) {
+        return;
+      }
+      while (locked.load(std::memory_order_relaxed)) {
+        if (++spins < 64) {
+          cpu_relax();
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    }
+  }
+
+  bool try_lock() noexcept {
+    return !locked.load(std::memory_order_relaxed) &&
+           !locked.exchange(true, std::memory_order_acquire);
+  }
+
+  void unlock() noexcept {
+    locked.store(false, std::memory_order_release);
+  }
+
+private:
+  std::atomic<bool> locked{false};
+};
+
+} // namespace detail
+
+/// Unordered concurrent collection of `list<T, Tag>` elements split into
+/// `N` shards, each a list with its own spinlock on its own cache lines, so
+/// threads working on different shards never contend. By default a thread
+/// inserts into the shard picked by its thread index, consecutive threads
+/// using consecutive shards; a hash may be given instead. An element stays
+/// in its shard until it's erased, popped or drained: erasing it needs the
+/// shard number `push` returned.
+/// Elements must not be inserted while contained in another list
+template <typename T, typename Tag = default_tag, std::size_t N = 16>
+struct sharded_list {
+  static_assert(N > 0, "sharded_list needs at least one shard");
+
+  using list_type = list<T, Tag>;
+
+  static constexpr std::size_t shard_count = N;
+
+  sharded_list() = default;
+
+  sharded_list(const sharded_list&) = delete;
+  sharded_list& operator=(const sharded_list&) = delete;
+
+  /// Shard the calling thread inserts into by default
+  static std::size_t local_shard() noexcept {
+    return detail::this_thread_index() % N;
+  }
+
+  /// Inserts `val` into the calling thread's shard, returns the shard
+  std::size_t push(T& val) noexcept {
+    return push(val, local_shard());
+  }
+
+  /// Inserts `val` into the shard `hash` maps to, returns the shard
+  std::size_t push(T& val, std::size_t hash) noexcept {
+    std::size_t index = hash % N;
+    shard& target = shards[index];
+    std::lock_guard guard{target.lock};
+    target.items.push_back(val);
+    return index;
+  }
+
+  /// Removes `val` from the shard `index`, which `push` returned for it
+  void erase(T& val, std::size_t index) noexcept {
+    assert(index < N);
+    shard& target = shards[index];
+    std::lock_guard guard{target.lock};
+    target.items.erase(target.items.iterator_to(val));
+  }
+
+  /// Removes an element, nullptr if there's none. The calling thread's
+  /// shard is tried first, then the others in order
+  T* try_pop() noexcept {
+    std::size_t first = local_shard();
+    for (std::size_t i = 0; i < N; ++i) {
+      shard& target = shards[(first + i) % N];
+      std::lock_guard guard{target.lock};
+      if (!target.items.empty()) {
+        T& result = target.items.front();
+        target.items.pop_front();
+        return &result;
+      }
+    }
+    return nullptr;
+  }
+
+  /// Moves all elements out, one O(1) splice per shard. Elements inserted
+  /// concurrently into already drained shards are left in place
+  list_type drain_all() noexcept {
+    list_type result;
+    for (shard& source : shards) {
+      std::lock_guard guard{source.lock};
+      result.splice(result.end(), source.items);
+    }
+    return result;
+  }
+
+  /// Returns true if every shard was empty when it was looked at
+  bool empty() const noexcept {
+    for (const shard& source : shards) {
+      std::lock_guard guard{source.lock};
+      if (!source.items.empty()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+private:
+  struct alignas(detail::cache_line_size) shard {
+    mutable detail::spinlock lock;
+    list_type items;
+  };
+
+  std::array<shard, N> shards;
+};
+
+} // namespace intrusive
@@ -0,0 +1,371 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace intrusive {
+struct default_tag;
+
+/// Tail policies of `slist`: `cache_last` stores a pointer to the last
+/// element, which makes `push_back`, `back` and whole-list splices O(1),
+/// `no_cache_last` keeps the list head a single pointer
+struct cache_last;
+struct no_cache_last;
+
+template <typename T, typename Tag, typename TailPolicy>
+struct slist;
+
+template <typename Tag>
+struct slist_element;
+
+template <typename Tag>
+struct atomic_slist_element;
+
+template <typename T, typename Tag>
+struct mpsc_queue;
+
+namespace detail {
+
+struct slist_base {
+  // NOTE: marker for non-connected node: next == this, the last node of a
+  // list has next == nullptr
+  constexpr slist_base() noexcept : next{this} {}
+
+  // A node can't be transplanted without its predecessor, so both copying
+  // and moving produce a non-connected node
+  constexpr slist_base(const slist_base&) noexcept : slist_base{} {}
+
+  slist_base& operator=(const slist_base&) = delete;
+
+  ~slist_base() = default;
+
+private:
+  /// Returns true if node is contained in some list or is a list head
+  constexpr bool is_linked() const noexcept {
+    return next != this;
+  }
+
+  /// Insert `other` after this node
+  constexpr void link_after(slist_base& other) noexcept {
+    other.next = next;
+    next = &other;
+  }
+
+  /// Remove the node following this one from the list and return it
+  constexpr slist_base* unlink_after() noexcept {
+    slist_base* result = next;
+    next = result->next;
+    result->next = result;
+    return result;
+  }
+
+  template <typename T, typename Tag, typename TailPolicy>
+  friend struct ::intrusive::slist;
+
+  template <typename Tag>
+  friend struct ::intrusive::slist_element;
+
+  slist_base* next;
+};
+
+/// Last element of a `cache_last` list, points to the head when empty
+struct slist_last {
+  slist_base* value;
+};
+
+/// Stand-in for the last element pointer of a `no_cache_last` list
+struct no_slist_last {};
+
+/// Singly linked node whose link may be accessed concurrently, the
+/// containers using it choose the memory orders
+struct atomic_slist_base {
+  // NOTE: marker for non-connected node: next == this
+  constexpr atomic_slist_base() noexcept : next{this} {}
+
+  // As with `slist_base`, copies are non-connected
+  constexpr atomic_slist_base(const atomic_slist_base&) noexcept
+      : atomic_slist_base{} {}
+
+  atomic_slist_base& operator=(const atomic_slist_base&) = delete;
+
+  ~atomic_slist_base() = default;
+
+private:
+  bool is_linked() const noexcept {
+    return next.load(std::memory_order_relaxed) != this;
+  }
+
+  template <typename T, typename Tag>
+  friend struct ::intrusive::mpsc_queue;
+
+  template <typename Tag>
+  friend struct ::intrusive::atomic_slist_element;
+
+  std::atomic<atomic_slist_base*> next;
+};
+
+} // namespace detail
+
+/// Singly linked hook for concurrent containers such as `mpsc_queue`. Like
+/// `slist_element` it must be removed from its container before being
+/// destroyed
+template <typename Tag = default_tag>
+struct atomic_slist_element : public detail::atomic_slist_base {
+  ~atomic_slist_element() {
+    assert(!is_linked());
+  }
+};
+
+/// Singly linked hook. Since an element can't unlink itself, it must be
+/// erased from its list before being destroyed
+template <typename Tag = default_tag>
+struct slist_element : public detail::slist_base {
+  constexpr ~slist_element() {
+    assert(!is_linked());
+  }
+};
+
+template <typename T, typename Tag = default_tag,
+          typename TailPolicy = no_cache_last>
+struct slist {
+  static_assert(std::is_base_of_v<slist_element<Tag>, T>,
+                "T should derive from slist_element<Tag>");
+  static_assert(std::is_same_v<TailPolicy, cache_last> ||
+                    std::is_same_v<TailPolicy, no_cache_last>,
+                "TailPolicy should be cache_last or no_cache_last");
+
+  static constexpr bool cache_last_v = std::is_same_v<TailPolicy, cache_last>;
+
+  slist() noexcept {
+    head.next = nullptr;
+    if constexpr (cache_last_v) {
+      last.value = &head;
+    }
+  }
+
+  slist(slist&& other) noexcept : slist{} {
+    take_chain(other);
+  }
+
+  slist& operator=(slist&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    take_chain(other);
+    return *this;
+  }
+
+  template <bool Const>
+  struct generic_iterator;
+
+  using iterator = generic_iterator<false>;
+  using const_iterator = generic_iterator<true>;
+
+  template <bool Const>
+  struct generic_iterator {
+    using value_type = std::conditional_t<Const, const T, T>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::forward_iterator_tag;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    generic_iterator() = default;
+    generic_iterator(const generic_iterator& iter) = default;
+
+    template <bool Dummy = Const, typename = std::enable_if_t<Dummy>>
+    generic_iterator(const iterator& iter) : data{iter.data} {}
+
+    pointer operator->() const {
+      return static_cast<pointer>(static_cast<slist_element<Tag>*>(data));
+    }
+
+    reference operator*() const {
+      return static_cast<reference>(static_cast<slist_element<Tag>&>(*data));
+    }
+
+    generic_iterator& operator++() {
+      data = data->next;
+      return *this;
+    }
+
+    generic_iterator operator++(int) {
+      generic_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    template <bool ConstRhs>
+    bool operator==(const generic_iterator<ConstRhs>& rhs) const {
+      return data == rhs.data;
+    }
+
+    template <bool ConstRhs>
+    bool operator!=(const generic_iterator<ConstRhs>& rhs) const {
+      return data != rhs.data;
+    }
+
+  private:
+    explicit generic_iterator(detail::slist_base* data_) : data{data_} {};
+    friend slist;
+
+    detail::slist_base* data{nullptr};
+  };
+
+  void push_front(T& val) noexcept {
+    insert_after(before_begin(), val);
+  }
+
+  template <bool Dummy = cache_last_v, typename = std::enable_if_t<Dummy>>
+  void push_back(T& val) noexcept {
+    insert_after(const_iterator{last.value}, val);
+  }
+
+  void pop_front() noexcept {
+    erase_after(before_begin());
+  }
+
+  void clear() noexcept {
+    while (!empty()) {
+      pop_front();
+    }
+  }
+
+  const T& front() const noexcept {
+    return *begin();
+  }
+
+  T& front() noexcept {
+    return *begin();
+  }
+
+  template <bool Dummy = cache_last_v, typename = std::enable_if_t<Dummy>>
+  const T& back() const noexcept {
+    return *const_iterator{last.value};
+  }
+
+  template <bool Dummy = cache_last_v, typename = std::enable_if_t<Dummy>>
+  T& back() noexcept {
+    return *iterator{last.value};
+  }
+
+  bool empty() const noexcept {
+    return head.next == nullptr;
+  }
+
+  /// Iterator that may only be incremented or passed to `*_after` functions
+  iterator before_begin() noexcept {
+    return iterator{&head};
+  }
+
+  const_iterator before_begin() const noexcept {
+    return const_iterator{const_cast<detail::slist_base*>(&head)};
+  }
+
+  iterator begin() noexcept {
+    return iterator{head.next};
+  }
+
+  const_iterator begin() const noexcept {
+    return const_iterator{head.next};
+  }
+
+  iterator end() noexcept {
+    return iterator{nullptr};
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator{nullptr};
+  }
+
+  /// `val` must not be contained in any list
+  iterator insert_after(const_iterator pos, T& val) noexcept {
+    auto ptr = static_cast<slist_element<Tag>*>(&val);
+    assert(!ptr->is_linked());
+    pos.data->link_after(*ptr);
+    if constexpr (cache_last_v) {
+      if (pos.data == last.value) {
+        last.value = ptr;
+      }
+    }
+    return iterator{ptr};
+  }
+
+  /// Erases the element following `pos` and returns the one after it
+  iterator erase_after(const_iterator pos) noexcept {
+    assert(pos.data->next != nullptr);
+    detail::slist_base* erased = pos.data->unlink_after();
+    if constexpr (cache_last_v) {
+      if (erased == last.value) {
+        last.value = pos.data;
+      }
+    }
+    return iterator{pos.data->next};
+  }
+
+  /// Moves (before_first, before_last] from `other` after `pos`, which must
+  /// not be inside the moved range
+  void splice_after(const_iterator pos, slist& other,
+                    const_iterator before_first,
+                    const_iterator before_last) noexcept {
+    if (before_first == before_last) {
+      return;
+    }
+    detail::slist_base* first = before_first.data->next;
+    before_first.data->next = before_last.data->next;
+    if constexpr (cache_last_v) {
+      if (other.last.value == before_last.data) {
+        other.last.value = before_first.data;
+      }
+    }
+
+    before_last.data->next = pos.data->next;
+    pos.data->next = first;
+    if constexpr (cache_last_v) {
+      if (last.value == pos.data) {
+        last.value = before_last.data;
+      }
+    }
+  }
+
+  /// Moves all elements of `other` after `pos`. O(1) with `cache_last`,
+  /// otherwise walks `other` to find its last element
+  void splice_after(const_iterator pos, slist& other) noexcept {
+    splice_after(pos, other, other.before_begin(), other.last_element());
+  }
+
+  ~slist() {
+    clear();
+  }
+
+private:
+  const_iterator last_element() const noexcept {
+    if constexpr (cache_last_v) {
+      return const_iterator{last.value};
+    } else {
+      const_iterator result = before_begin();
+      while (result.data->next != nullptr) {
+        ++result;
+      }
+      return result;
+    }
+  }
+
+  void take_chain(slist& other) noexcept {
+    head.next = std::exchange(other.head.next, nullptr);
+    if constexpr (cache_last_v) {
+      last.value = other.last.value == &other.head ? &head : other.last.value;
+      other.last.value = &other.head;
+    }
+  }
+
+  detail::slist_base head;
+  [[no_unique_address]] std::conditional_t<
+      cache_last_v, detail::slist_last, detail::no_slist_last> last;
+};
+
+} // namespace intrusive
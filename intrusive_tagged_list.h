@@ -0,0 +1,366 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace intrusive {
+struct default_tag;
+
+template <typename T, typename Tag>
+struct tagged_list;
+
+template <typename Tag, std::size_t FlagBits>
+struct tagged_list_element;
+
+namespace detail {
+
+/// Doubly linked node keeping user flags in the low bits of `next`, which
+/// are always zero in a pointer to a node
+struct tagged_list_base {
+  static constexpr std::uintptr_t flag_mask = alignof(void*) - 1;
+
+  // NOTE: marker for non-connected/sentinel node: prev == next == this
+  tagged_list_base() noexcept : prev{this}, next_bits{address(this)} {}
+
+  tagged_list_base(tagged_list_base&& other) noexcept : tagged_list_base{} {
+    *this = std::move(other);
+  }
+
+  // Flags are the element's state and are copied, links aren't
+  tagged_list_base(const tagged_list_base& other) noexcept
+      : tagged_list_base{} {
+    next_bits |= other.stored_flags();
+  }
+
+  /// Takes over `other`'s place in its list and its flags
+  tagged_list_base& operator=(tagged_list_base&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    assert(is_single()); // otherwise it's illegal to do an assignment
+    std::uintptr_t flags = other.stored_flags();
+    if (!other.is_single()) {
+      prev = other.prev;
+      set_next(other.next());
+      prev->set_next(this);
+      next()->prev = this;
+      other.prev = &other;
+      other.set_next(&other);
+    }
+    next_bits = (next_bits & ~flag_mask) | flags;
+    return *this;
+  }
+
+  tagged_list_base& operator=(const tagged_list_base&) = delete;
+
+  ~tagged_list_base() = default;
+
+private:
+  static std::uintptr_t address(const tagged_list_base* node) noexcept {
+    return reinterpret_cast<std::uintptr_t>(node);
+  }
+
+  tagged_list_base* next() const noexcept {
+    return reinterpret_cast<tagged_list_base*>(next_bits & ~flag_mask);
+  }
+
+  /// Replaces the `next` link, keeping the flags
+  void set_next(tagged_list_base* node) noexcept {
+    next_bits = address(node) | (next_bits & flag_mask);
+  }
+
+  std::uintptr_t stored_flags() const noexcept {
+    return next_bits & flag_mask;
+  }
+
+  void store_flags(std::uintptr_t bits) noexcept {
+    assert((bits & ~flag_mask) == 0);
+    next_bits = (next_bits & ~flag_mask) | bits;
+  }
+
+  /// Returns true if node is not contained in any list or is a sentinel
+  bool is_single() const noexcept {
+    return prev == this && next() == this;
+  }
+
+  /// Remove node from a list (has no effect if a node is single)
+  void unlink() noexcept {
+    prev->set_next(next());
+    next()->prev = prev;
+    prev = this;
+    set_next(this);
+  }
+
+  /// Insert `other` before this node, `other`'s links are ignored
+  void link_before(tagged_list_base& other) noexcept {
+    prev->set_next(&other);
+    other.prev = prev;
+    other.set_next(this);
+    prev = &other;
+  }
+
+  template <typename T, typename Tag>
+  friend struct ::intrusive::tagged_list;
+
+  template <typename Tag, std::size_t FlagBits>
+  friend struct ::intrusive::tagged_list_element;
+
+  tagged_list_base* prev;
+  std::uintptr_t next_bits;
+};
+
+/// Base of all `tagged_list_element`s with the same tag, regardless of the
+/// number of flags they expose
+template <typename Tag>
+struct tagged_list_hook : tagged_list_base {};
+
+} // namespace detail
+
+/// Hook for `tagged_list` exposing `FlagBits` bits of user state stored in
+/// the alignment bits of its links, so the element doesn't need separate
+/// `bool` or small enum fields. Flags survive linking and unlinking, are
+/// copied with the element and moved with it. Like a `safe` `list_element`
+/// a destroyed element unlinks itself
+template <typename Tag = default_tag, std::size_t FlagBits = 2>
+struct tagged_list_element : public detail::tagged_list_hook<Tag> {
+  static_assert(FlagBits > 0 && ((std::uintptr_t{1} << FlagBits) - 1) <=
+                                    detail::tagged_list_base::flag_mask,
+                "FlagBits exceeds the alignment bits of a pointer");
+
+  static constexpr std::size_t flag_bits = FlagBits;
+
+  tagged_list_element() noexcept = default;
+  tagged_list_element(const tagged_list_element&) noexcept = default;
+  tagged_list_element(tagged_list_element&&) noexcept = default;
+  tagged_list_element& operator=(tagged_list_element&&) noexcept = default;
+
+  /// All flags as an integer in [0, 2^FlagBits)
+  unsigned flags() const noexcept {
+    return static_cast<unsigned>(this->stored_flags());
+  }
+
+  void set_flags(unsigned value) noexcept {
+    assert(value < (1u << FlagBits));
+    this->store_flags(value);
+  }
+
+  bool flag(std::size_t index) const noexcept {
+    assert(index < FlagBits);
+    return (flags() >> index) & 1;
+  }
+
+  void set_flag(std::size_t index, bool value = true) noexcept {
+    assert(index < FlagBits);
+    unsigned mask = 1u << index;
+    set_flags(value ? flags() | mask : flags() & ~mask);
+  }
+
+  ~tagged_list_element() {
+    this->unlink();
+  }
+};
+
+/// Doubly linked list over `tagged_list_element` hooks. Links are masked
+/// whenever they're followed, the flags are never touched by the list
+template <typename T, typename Tag = default_tag>
+struct tagged_list {
+  using hook_type = detail::tagged_list_hook<Tag>;
+  static_assert(std::is_base_of_v<hook_type, T>,
+                "T should derive from tagged_list_element<Tag, FlagBits>");
+
+  tagged_list() = default;
+
+  tagged_list(tagged_list&& other) noexcept = default;
+
+  tagged_list& operator=(tagged_list&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    sentinel = std::move(other.sentinel);
+    return *this;
+  }
+
+  template <bool Const>
+  struct generic_iterator;
+
+  using iterator = generic_iterator<false>;
+  using const_iterator = generic_iterator<true>;
+
+  template <bool Const>
+  struct generic_iterator {
+    using value_type = std::conditional_t<Const, const T, T>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    generic_iterator() = default;
+    generic_iterator(const generic_iterator& iter) = default;
+
+    template <bool Dummy = Const, typename = std::enable_if_t<Dummy>>
+    generic_iterator(const iterator& iter) : data{iter.data} {}
+
+    pointer operator->() const {
+      return static_cast<pointer>(static_cast<hook_type*>(data));
+    }
+
+    reference operator*() const {
+      return *operator->();
+    }
+
+    generic_iterator& operator++() {
+      data = data->next();
+      return *this;
+    }
+
+    generic_iterator operator++(int) {
+      generic_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    generic_iterator& operator--() {
+      data = data->prev;
+      return *this;
+    }
+
+    generic_iterator operator--(int) {
+      generic_iterator result = *this;
+      --*this;
+      return result;
+    }
+
+    template <bool ConstRhs>
+    bool operator==(const generic_iterator<ConstRhs>& rhs) const {
+      return data == rhs.data;
+    }
+
+    template <bool ConstRhs>
+    bool operator!=(const generic_iterator<ConstRhs>& rhs) const {
+      return data != rhs.data;
+    }
+
+  private:
+    explicit generic_iterator(detail::tagged_list_base* data_)
+        : data{data_} {};
+    friend tagged_list;
+
+    detail::tagged_list_base* data{nullptr};
+  };
+
+  void push_back(T& val) noexcept {
+    insert(end(), val);
+  }
+
+  void push_front(T& val) noexcept {
+    insert(begin(), val);
+  }
+
+  void clear() noexcept {
+    while (!empty()) {
+      pop_back();
+    }
+  }
+
+  void pop_back() noexcept {
+    erase(std::prev(end()));
+  }
+
+  void pop_front() noexcept {
+    erase(begin());
+  }
+
+  const T& back() const noexcept {
+    return *std::prev(end());
+  }
+
+  T& back() noexcept {
+    return *std::prev(end());
+  }
+
+  const T& front() const noexcept {
+    return *begin();
+  }
+
+  T& front() noexcept {
+    return *begin();
+  }
+
+  bool empty() const noexcept {
+    return sentinel.is_single();
+  }
+
+  iterator begin() noexcept {
+    return iterator{sentinel.next()};
+  }
+
+  const_iterator begin() const noexcept {
+    return const_iterator{sentinel.next()};
+  }
+
+  iterator end() noexcept {
+    return iterator{&sentinel};
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator{const_cast<detail::tagged_list_base*>(&sentinel)};
+  }
+
+  /// Iterator to `val`, which must be contained in this list. O(1)
+  iterator iterator_to(T& val) noexcept {
+    return iterator{static_cast<hook_type*>(&val)};
+  }
+
+  const_iterator iterator_to(const T& val) const noexcept {
+    return const_iterator{static_cast<hook_type*>(const_cast<T*>(&val))};
+  }
+
+  /// Inserts `val` before `pos`, unlinking it from its previous list
+  iterator insert(const_iterator pos, T& val) noexcept {
+    detail::tagged_list_base* node = static_cast<hook_type*>(&val);
+    if (node == pos.data) {
+      return iterator{node};
+    }
+    node->unlink();
+    pos.data->link_before(*node);
+    return iterator{node};
+  }
+
+  iterator erase(const_iterator pos) noexcept {
+    assert(!empty());
+    detail::tagged_list_base* next = pos.data->next();
+    pos.data->unlink();
+    return iterator{next};
+  }
+
+  /// Moves all elements of `other` before `pos` in O(1)
+  void splice(const_iterator pos, tagged_list& other) noexcept {
+    if (other.empty() || this == &other) {
+      return;
+    }
+    detail::tagged_list_base* first = other.sentinel.next();
+    detail::tagged_list_base* last = other.sentinel.prev;
+    other.sentinel.prev = &other.sentinel;
+    other.sentinel.set_next(&other.sentinel);
+
+    detail::tagged_list_base* before = pos.data->prev;
+    before->set_next(first);
+    first->prev = before;
+    last->set_next(pos.data);
+    pos.data->prev = last;
+  }
+
+  ~tagged_list() {
+    clear();
+  }
+
+private:
+  detail::tagged_list_base sentinel;
+};
+
+} // namespace intrusive
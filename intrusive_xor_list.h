@@ -0,0 +1,310 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace intrusive {
+struct default_tag;
+
+template <typename T, typename Tag>
+struct xor_list;
+
+template <typename Tag>
+struct xor_list_element;
+
+namespace detail {
+
+struct xor_list_base {
+  // NOTE: marker for non-connected node. Links of connected nodes are XORs
+  // of two aligned pointers, so their lowest bit is never set
+  static constexpr std::uintptr_t unlinked = ~std::uintptr_t{0};
+
+  constexpr xor_list_base() noexcept = default;
+
+  // Neighbours refer to the original by its address, so a copy can't take
+  // its place in the list
+  constexpr xor_list_base(const xor_list_base&) noexcept : xor_list_base{} {}
+
+  xor_list_base& operator=(const xor_list_base&) = delete;
+
+  ~xor_list_base() = default;
+
+private:
+  constexpr bool is_linked() const noexcept {
+    return link != unlinked;
+  }
+
+  /// The neighbour on the other side from `from`
+  xor_list_base* other(const xor_list_base* from) const noexcept {
+    return reinterpret_cast<xor_list_base*>(
+        link ^ reinterpret_cast<std::uintptr_t>(from));
+  }
+
+  /// Replaces neighbour `old_neighbour` with `new_neighbour`
+  void replace(const xor_list_base* old_neighbour,
+               const xor_list_base* new_neighbour) noexcept {
+    link ^= reinterpret_cast<std::uintptr_t>(old_neighbour) ^
+            reinterpret_cast<std::uintptr_t>(new_neighbour);
+  }
+
+  void set(const xor_list_base* prev, const xor_list_base* next) noexcept {
+    link = reinterpret_cast<std::uintptr_t>(prev) ^
+           reinterpret_cast<std::uintptr_t>(next);
+  }
+
+  template <typename T, typename Tag>
+  friend struct ::intrusive::xor_list;
+
+  template <typename Tag>
+  friend struct ::intrusive::xor_list_element;
+
+  std::uintptr_t link{unlinked};
+};
+
+} // namespace detail
+
+/// One-word hook storing `prev ^ next`, half the size of `list_element`.
+/// Neighbours can only be found while walking from one of them, so an
+/// element can't be unlinked or found in O(1) by itself: it has to be
+/// erased through an iterator before being destroyed
+template <typename Tag = default_tag>
+struct xor_list_element : public detail::xor_list_base {
+  constexpr ~xor_list_element() {
+    assert(!is_linked());
+  }
+};
+
+/// Doubly linked list over `xor_list_element` hooks, meant for lists that
+/// are mostly traversed. Iterators carry the previous node along, so
+/// inserting or erasing invalidates iterators to the neighbours of the
+/// affected position
+template <typename T, typename Tag = default_tag>
+struct xor_list {
+  static_assert(std::is_base_of_v<xor_list_element<Tag>, T>,
+                "T should derive from xor_list_element<Tag>");
+
+  xor_list() = default;
+
+  xor_list(xor_list&& other) noexcept
+      : head{std::exchange(other.head, nullptr)},
+        tail{std::exchange(other.tail, nullptr)} {}
+
+  xor_list& operator=(xor_list&& other) noexcept {
+    if (this == &other) {
+      return *this;
+    }
+    clear();
+    head = std::exchange(other.head, nullptr);
+    tail = std::exchange(other.tail, nullptr);
+    return *this;
+  }
+
+  template <bool Const>
+  struct generic_iterator;
+
+  using iterator = generic_iterator<false>;
+  using const_iterator = generic_iterator<true>;
+
+  template <bool Const>
+  struct generic_iterator {
+    using value_type = std::conditional_t<Const, const T, T>;
+    using difference_type = std::ptrdiff_t;
+    using iterator_category = std::bidirectional_iterator_tag;
+    using pointer = value_type*;
+    using reference = value_type&;
+
+    generic_iterator() = default;
+    generic_iterator(const generic_iterator& iter) = default;
+
+    template <bool Dummy = Const, typename = std::enable_if_t<Dummy>>
+    generic_iterator(const iterator& iter) : prev{iter.prev}, data{iter.data} {}
+
+    pointer operator->() const {
+      return static_cast<pointer>(static_cast<xor_list_element<Tag>*>(data));
+    }
+
+    reference operator*() const {
+      return *operator->();
+    }
+
+    generic_iterator& operator++() {
+      detail::xor_list_base* next = data->other(prev);
+      prev = data;
+      data = next;
+      return *this;
+    }
+
+    generic_iterator operator++(int) {
+      generic_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    generic_iterator& operator--() {
+      detail::xor_list_base* before = prev->other(data);
+      data = prev;
+      prev = before;
+      return *this;
+    }
+
+    generic_iterator operator--(int) {
+      generic_iterator result = *this;
+      --*this;
+      return result;
+    }
+
+    template <bool ConstRhs>
+    bool operator==(const generic_iterator<ConstRhs>& rhs) const {
+      return data == rhs.data;
+    }
+
+    template <bool ConstRhs>
+    bool operator!=(const generic_iterator<ConstRhs>& rhs) const {
+      return data != rhs.data;
+    }
+
+  private:
+    generic_iterator(detail::xor_list_base* prev_,
+                     detail::xor_list_base* data_)
+        : prev{prev_}, data{data_} {};
+    friend xor_list;
+
+    // nullptr before the first and past the last element
+    detail::xor_list_base* prev{nullptr};
+    detail::xor_list_base* data{nullptr};
+  };
+
+  void push_back(T& val) noexcept {
+    insert(end(), val);
+  }
+
+  void push_front(T& val) noexcept {
+    insert(begin(), val);
+  }
+
+  void clear() noexcept {
+    while (!empty()) {
+      pop_back();
+    }
+  }
+
+  void pop_back() noexcept {
+    erase(std::prev(end()));
+  }
+
+  void pop_front() noexcept {
+    erase(begin());
+  }
+
+  const T& back() const noexcept {
+    return *std::prev(end());
+  }
+
+  T& back() noexcept {
+    return *std::prev(end());
+  }
+
+  const T& front() const noexcept {
+    return *begin();
+  }
+
+  T& front() noexcept {
+    return *begin();
+  }
+
+  bool empty() const noexcept {
+    return head == nullptr;
+  }
+
+  iterator begin() noexcept {
+    return iterator{nullptr, head};
+  }
+
+  const_iterator begin() const noexcept {
+    return const_iterator{nullptr, head};
+  }
+
+  iterator end() noexcept {
+    return iterator{tail, nullptr};
+  }
+
+  const_iterator end() const noexcept {
+    return const_iterator{tail, nullptr};
+  }
+
+  /// `val` must not be contained in any list
+  iterator insert(const_iterator pos, T& val) noexcept {
+    detail::xor_list_base* node = static_cast<xor_list_element<Tag>*>(&val);
+    assert(!node->is_linked());
+    node->set(pos.prev, pos.data);
+    link_between(pos.prev, pos.data, node, node);
+    return iterator{pos.prev, node};
+  }
+
+  iterator erase(const_iterator pos) noexcept {
+    assert(!empty());
+    detail::xor_list_base* node = pos.data;
+    detail::xor_list_base* next = node->other(pos.prev);
+    if (pos.prev == nullptr) {
+      head = next;
+    } else {
+      pos.prev->replace(node, next);
+    }
+    if (next == nullptr) {
+      tail = pos.prev;
+    } else {
+      next->replace(node, pos.prev);
+    }
+    node->link = detail::xor_list_base::unlinked;
+    return iterator{pos.prev, next};
+  }
+
+  /// Moves all elements of `other` before `pos` in O(1)
+  void splice(const_iterator pos, xor_list& other) noexcept {
+    if (other.empty() || this == &other) {
+      return;
+    }
+    detail::xor_list_base* first = std::exchange(other.head, nullptr);
+    detail::xor_list_base* last = std::exchange(other.tail, nullptr);
+    // the ends of a list have a null neighbour outside of it
+    first->replace(nullptr, pos.prev);
+    last->replace(nullptr, pos.data);
+    link_between(pos.prev, pos.data, first, last);
+  }
+
+  /// Reverses the order of elements in O(1), as the links are symmetric
+  void reverse() noexcept {
+    std::swap(head, tail);
+  }
+
+  ~xor_list() {
+    clear();
+  }
+
+private:
+  /// Makes `prev` and `next` refer to the chain [first, last] instead of
+  /// each other, the chain's own outer links must already be set
+  void link_between(detail::xor_list_base* prev, detail::xor_list_base* next,
+                    detail::xor_list_base* first,
+                    detail::xor_list_base* last) noexcept {
+    if (prev == nullptr) {
+      head = first;
+    } else {
+      prev->replace(next, first);
+    }
+    if (next == nullptr) {
+      tail = last;
+    } else {
+      next->replace(prev, last);
+    }
+  }
+
+  detail::xor_list_base* head{nullptr};
+  detail::xor_list_base* tail{nullptr};
+};
+
+} // namespace intrusive
@@ -28,6 +28,11 @@ void expect_eq_impl(E expected_first, E expected_last, A actual_first,
   }
 }
 
+template <typename C>
+void expect_forward_eq(C& cont, std::initializer_list<int> values) {
+  expect_eq_impl(values.begin(), values.end(), cont.begin(), cont.end());
+}
+
 template <typename C>
 void expect_eq(C& cont, std::initializer_list<int> values) {
   expect_eq_impl(values.begin(), values.end(), cont.begin(), cont.end());